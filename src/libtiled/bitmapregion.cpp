@@ -0,0 +1,272 @@
+/*
+ * bitmapregion.cpp
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bitmapregion.h"
+
+#include "regionbuilder.h"
+
+#include <QtAlgorithms>
+
+namespace Tiled {
+
+/**
+ * Returns a row mask with the bits \a first to \a last (inclusive) set.
+ */
+static quint64 rowMask(int first, int last)
+{
+    const quint64 upTo = last == 63 ? ~quint64(0) : (quint64(1) << (last + 1)) - 1;
+    return upTo & ~((quint64(1) << first) - 1);
+}
+
+/**
+ * Adds a span to \a builder for each run of set bits in the given row.
+ */
+static void addSpans(RegionBuilder &builder, quint64 bits, int originX, int y)
+{
+    while (bits) {
+        const int first = qCountTrailingZeroBits(bits);
+
+        // Adding the lowest set bit carries through the run of set bits
+        const quint64 carried = bits + (quint64(1) << first);
+        const int end = carried ? qCountTrailingZeroBits(carried) : 64;
+
+        builder.addSpan(originX + first, originX + end - 1, y);
+        bits &= carried;
+    }
+}
+
+BitmapRegion::BitmapRegion(const QRect &rect)
+{
+    addRect(rect);
+}
+
+BitmapRegion::BitmapRegion(const QRegion &region)
+{
+#if QT_VERSION < 0x050800
+    const auto rects = region.rects();
+    for (const QRect &rect : rects)
+#else
+    for (const QRect &rect : region)
+#endif
+        addRect(rect);
+}
+
+bool BitmapRegion::isEmpty(const Chunk &chunk)
+{
+    for (quint64 row : chunk)
+        if (row)
+            return false;
+    return true;
+}
+
+QRect BitmapRegion::boundingRect() const
+{
+    QRect bounds;
+
+    for (auto it = mChunks.cbegin(); it != mChunks.cend(); ++it) {
+        const Chunk &chunk = it.value();
+        const int originX = chunkX(it.key()) * ChunkSize;
+        const int originY = chunkY(it.key()) * ChunkSize;
+
+        quint64 columns = 0;
+        int top = -1;
+        int bottom = -1;
+        for (int y = 0; y < ChunkSize; ++y) {
+            if (chunk[y]) {
+                columns |= chunk[y];
+                if (top == -1)
+                    top = y;
+                bottom = y;
+            }
+        }
+
+        const int left = qCountTrailingZeroBits(columns);
+        const int right = 63 - qCountLeadingZeroBits(columns);
+        bounds |= QRect(QPoint(originX + left, originY + top),
+                        QPoint(originX + right, originY + bottom));
+    }
+
+    return bounds;
+}
+
+/**
+ * Adds the cells within \a rect to this region.
+ */
+void BitmapRegion::addRect(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    const int firstChunkX = chunkIndex(rect.left());
+    const int lastChunkX = chunkIndex(rect.right());
+    const int firstChunkY = chunkIndex(rect.top());
+    const int lastChunkY = chunkIndex(rect.bottom());
+
+    for (int cy = firstChunkY; cy <= lastChunkY; ++cy) {
+        const int firstRow = qMax(rect.top() - cy * ChunkSize, 0);
+        const int lastRow = qMin(rect.bottom() - cy * ChunkSize, int(ChunkMask));
+
+        for (int cx = firstChunkX; cx <= lastChunkX; ++cx) {
+            const quint64 mask = rowMask(qMax(rect.left() - cx * ChunkSize, 0),
+                                         qMin(rect.right() - cx * ChunkSize, int(ChunkMask)));
+
+            auto it = mChunks.find(chunkKey(cx, cy));
+            if (it == mChunks.end())
+                it = mChunks.insert(chunkKey(cx, cy), Chunk {});
+
+            Chunk &chunk = it.value();
+            for (int row = firstRow; row <= lastRow; ++row)
+                chunk[row] |= mask;
+        }
+    }
+}
+
+BitmapRegion BitmapRegion::united(const BitmapRegion &other) const
+{
+    if (mChunks.size() < other.mChunks.size())
+        return other.united(*this);
+
+    BitmapRegion result = *this;
+
+    for (auto it = other.mChunks.cbegin(); it != other.mChunks.cend(); ++it) {
+        auto resultIt = result.mChunks.find(it.key());
+        if (resultIt == result.mChunks.end()) {
+            result.mChunks.insert(it.key(), it.value());
+        } else {
+            Chunk &chunk = resultIt.value();
+            for (int y = 0; y < ChunkSize; ++y)
+                chunk[y] |= it.value()[y];
+        }
+    }
+
+    return result;
+}
+
+BitmapRegion BitmapRegion::subtracted(const BitmapRegion &other) const
+{
+    BitmapRegion result = *this;
+
+    for (auto it = other.mChunks.cbegin(); it != other.mChunks.cend(); ++it) {
+        auto resultIt = result.mChunks.find(it.key());
+        if (resultIt == result.mChunks.end())
+            continue;
+
+        Chunk &chunk = resultIt.value();
+        for (int y = 0; y < ChunkSize; ++y)
+            chunk[y] &= ~it.value()[y];
+
+        if (isEmpty(chunk))
+            result.mChunks.erase(resultIt);
+    }
+
+    return result;
+}
+
+BitmapRegion BitmapRegion::intersected(const BitmapRegion &other) const
+{
+    if (mChunks.size() > other.mChunks.size())
+        return other.intersected(*this);
+
+    BitmapRegion result;
+
+    for (auto it = mChunks.cbegin(); it != mChunks.cend(); ++it) {
+        auto otherIt = other.mChunks.find(it.key());
+        if (otherIt == other.mChunks.end())
+            continue;
+
+        Chunk chunk;
+        for (int y = 0; y < ChunkSize; ++y)
+            chunk[y] = it.value()[y] & otherIt.value()[y];
+
+        if (!isEmpty(chunk))
+            result.mChunks.insert(it.key(), chunk);
+    }
+
+    return result;
+}
+
+/**
+ * Returns the part of \a region that is covered by this region. Only the
+ * chunks overlapping \a region are looked at, which makes this cheap for
+ * small regions like a brush.
+ */
+QRegion BitmapRegion::intersected(const QRegion &region) const
+{
+    RegionBuilder builder;
+
+#if QT_VERSION < 0x050800
+    const auto rects = region.rects();
+    for (const QRect &rect : rects) {
+#else
+    for (const QRect &rect : region) {
+#endif
+        const int firstChunkX = chunkIndex(rect.left());
+        const int lastChunkX = chunkIndex(rect.right());
+
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            const int cy = chunkIndex(y);
+            const int row = y & ChunkMask;
+
+            for (int cx = firstChunkX; cx <= lastChunkX; ++cx) {
+                auto it = mChunks.find(chunkKey(cx, cy));
+                if (it == mChunks.end())
+                    continue;
+
+                const int originX = cx * ChunkSize;
+                const quint64 bits = it.value()[row] &
+                        rowMask(qMax(rect.left() - originX, 0),
+                                qMin(rect.right() - originX, int(ChunkMask)));
+
+                addSpans(builder, bits, originX, y);
+            }
+        }
+    }
+
+    return builder.region();
+}
+
+/**
+ * Converts this region to a QRegion.
+ */
+QRegion BitmapRegion::toRegion() const
+{
+    RegionBuilder builder;
+
+    for (auto it = mChunks.cbegin(); it != mChunks.cend(); ++it) {
+        const Chunk &chunk = it.value();
+        const int originX = chunkX(it.key()) * ChunkSize;
+        const int originY = chunkY(it.key()) * ChunkSize;
+
+        for (int y = 0; y < ChunkSize; ++y) {
+            addSpans(builder, chunk[y], originX, originY + y);
+        }
+    }
+
+    return builder.region();
+}
+
+} // namespace Tiled
@@ -0,0 +1,157 @@
+/*
+ * bitmapregion.h
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QHash>
+#include <QRect>
+#include <QRegion>
+
+#include <array>
+
+namespace Tiled {
+
+/**
+ * A region of cells stored as a sparse set of bitmap chunks.
+ *
+ * Regions like those produced by the magic wand can consist of a huge
+ * amount of rectangles, which makes QRegion slow for looking up individual
+ * cells and for boolean operations. This class answers contains() in
+ * constant time and its boolean operations only depend on the number of
+ * chunks involved. Use toRegion() when a QRegion is needed, for example for
+ * drawing the outline of the region.
+ */
+class TILEDSHARED_EXPORT BitmapRegion
+{
+public:
+    BitmapRegion() {}
+    explicit BitmapRegion(const QRect &rect);
+    explicit BitmapRegion(const QRegion &region);
+
+    bool isEmpty() const;
+
+    bool contains(int x, int y) const;
+    bool contains(const QPoint &point) const;
+
+    QRect boundingRect() const;
+
+    void addRect(const QRect &rect);
+
+    BitmapRegion united(const BitmapRegion &other) const;
+    BitmapRegion subtracted(const BitmapRegion &other) const;
+    BitmapRegion intersected(const BitmapRegion &other) const;
+    QRegion intersected(const QRegion &region) const;
+
+    BitmapRegion &operator+=(const BitmapRegion &other);
+    BitmapRegion &operator-=(const BitmapRegion &other);
+    BitmapRegion &operator&=(const BitmapRegion &other);
+
+    BitmapRegion operator+(const BitmapRegion &other) const { return united(other); }
+    BitmapRegion operator-(const BitmapRegion &other) const { return subtracted(other); }
+    BitmapRegion operator&(const BitmapRegion &other) const { return intersected(other); }
+
+    bool operator==(const BitmapRegion &other) const { return mChunks == other.mChunks; }
+    bool operator!=(const BitmapRegion &other) const { return mChunks != other.mChunks; }
+
+    QRegion toRegion() const;
+
+private:
+    enum {
+        ChunkBits = 6,
+        ChunkSize = 1 << ChunkBits,
+        ChunkMask = ChunkSize - 1
+    };
+
+    // One 64-bit word per row of a chunk. Chunks without any cells set are
+    // never stored, so that equal regions have equal chunk hashes.
+    typedef std::array<quint64, ChunkSize> Chunk;
+
+    static int chunkIndex(int coordinate);
+    static quint64 chunkKey(int chunkX, int chunkY);
+    static int chunkX(quint64 key);
+    static int chunkY(quint64 key);
+    static bool isEmpty(const Chunk &chunk);
+
+    QHash<quint64, Chunk> mChunks;
+};
+
+inline bool BitmapRegion::isEmpty() const
+{
+    return mChunks.isEmpty();
+}
+
+inline bool BitmapRegion::contains(int x, int y) const
+{
+    auto it = mChunks.find(chunkKey(chunkIndex(x), chunkIndex(y)));
+    if (it == mChunks.end())
+        return false;
+    return (it.value()[y & ChunkMask] >> (x & ChunkMask)) & 1;
+}
+
+inline bool BitmapRegion::contains(const QPoint &point) const
+{
+    return contains(point.x(), point.y());
+}
+
+inline BitmapRegion &BitmapRegion::operator+=(const BitmapRegion &other)
+{
+    return *this = united(other);
+}
+
+inline BitmapRegion &BitmapRegion::operator-=(const BitmapRegion &other)
+{
+    return *this = subtracted(other);
+}
+
+inline BitmapRegion &BitmapRegion::operator&=(const BitmapRegion &other)
+{
+    return *this = intersected(other);
+}
+
+inline int BitmapRegion::chunkIndex(int coordinate)
+{
+    return coordinate < 0 ? (coordinate + 1) / ChunkSize - 1 : coordinate / ChunkSize;
+}
+
+inline quint64 BitmapRegion::chunkKey(int chunkX, int chunkY)
+{
+    return (quint64(quint32(chunkY)) << 32) | quint32(chunkX);
+}
+
+inline int BitmapRegion::chunkX(quint64 key)
+{
+    return int(quint32(key));
+}
+
+inline int BitmapRegion::chunkY(quint64 key)
+{
+    return int(quint32(key >> 32));
+}
+
+} // namespace Tiled
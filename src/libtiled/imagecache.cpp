@@ -29,9 +29,137 @@
 #include "imagecache.h"
 
 #include <QBitmap>
+#include <QImageReader>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
 
 namespace Tiled {
 
+namespace {
+
+// Preloaded images that are not picked up are dropped, oldest first, once
+// they take more memory than this
+const qint64 PRELOAD_BUDGET = 64 * 1024 * 1024;
+
+struct PreloadedImage
+{
+    QImage image;
+    quint64 sequence;
+};
+
+/**
+ * Images decoded on the thread pool, waiting to be picked up by
+ * ImageCache::loadImage.
+ */
+struct PreloadedImages
+{
+    PreloadedImages()
+        : nextSequence(0)
+        , bytes(0)
+        , receiver(nullptr)
+        , member(nullptr)
+    {}
+
+    void insert(const QString &fileName, const QImage &image);
+    bool take(const QString &fileName, QImage *image);
+
+    QMutex mutex;
+    QSet<QString> pending;
+    QHash<QString, PreloadedImage> images;
+    QMap<quint64, QString> fileNamesByAge;
+    quint64 nextSequence;
+    qint64 bytes;
+
+    QObject *receiver;
+    const char *member;
+};
+
+void PreloadedImages::insert(const QString &fileName, const QImage &image)
+{
+    const PreloadedImage preloaded { image, nextSequence++ };
+    images.insert(fileName, preloaded);
+    fileNamesByAge.insert(preloaded.sequence, fileName);
+    bytes += image.byteCount();
+
+    while (bytes > PRELOAD_BUDGET && fileNamesByAge.size() > 1) {
+        const QString oldest = fileNamesByAge.take(fileNamesByAge.firstKey());
+        bytes -= images.take(oldest).image.byteCount();
+    }
+}
+
+bool PreloadedImages::take(const QString &fileName, QImage *image)
+{
+    auto it = images.find(fileName);
+    if (it == images.end())
+        return false;
+
+    fileNamesByAge.remove(it.value().sequence);
+    bytes -= it.value().image.byteCount();
+    if (image)
+        *image = it.value().image;
+    images.erase(it);
+    return true;
+}
+
+Q_GLOBAL_STATIC(PreloadedImages, preloadedImages)
+
+class ImagePreloader : public QRunnable
+{
+public:
+    explicit ImagePreloader(const QString &fileName)
+        : mFileName(fileName)
+    {}
+
+    void run() override
+    {
+        const QImage image(mFileName);
+
+        PreloadedImages *preloaded = preloadedImages();
+        QMutexLocker locker(&preloaded->mutex);
+
+        // The image may have been loaded or removed in the meantime
+        if (!preloaded->pending.remove(mFileName))
+            return;
+
+        preloaded->insert(mFileName, image);
+
+        if (preloaded->receiver) {
+            QMetaObject::invokeMethod(preloaded->receiver, preloaded->member,
+                                      Qt::QueuedConnection,
+                                      Q_ARG(QString, mFileName));
+        }
+    }
+
+private:
+    const QString mFileName;
+};
+
+/**
+ * Takes the image decoded by a preloader into \a image, if any. Otherwise,
+ * any preloader still in progress for the file is told to discard its result.
+ */
+bool takePreloadedImage(const QString &fileName, QImage *image)
+{
+    // May be called after the global has been destroyed on exit
+    PreloadedImages *preloaded = preloadedImages();
+    if (!preloaded)
+        return false;
+
+    QMutexLocker locker(&preloaded->mutex);
+
+    if (preloaded->take(fileName, image))
+        return true;
+
+    preloaded->pending.remove(fileName);
+    return false;
+}
+
+} // anonymous namespace
+
 bool TilesheetParameters::operator==(const TilesheetParameters &other) const
 {
     return fileName == other.fileName &&
@@ -61,8 +189,12 @@ QHash<TilesheetParameters, QVector<QPixmap>> ImageCache::sCutTiles;
 QImage ImageCache::loadImage(const QString &fileName)
 {
     auto it = sLoadedImages.find(fileName);
-    if (it == sLoadedImages.end())
-        it = sLoadedImages.insert(fileName, QImage(fileName));
+    if (it == sLoadedImages.end()) {
+        QImage image;
+        if (!takePreloadedImage(fileName, &image))
+            image = QImage(fileName);
+        it = sLoadedImages.insert(fileName, image);
+    }
     return it.value();
 }
 
@@ -74,6 +206,98 @@ QPixmap ImageCache::loadPixmap(const QString &fileName)
     return it.value();
 }
 
+/**
+ * Loads the pixmap from the given file without keeping it in the cache, so
+ * that its memory is released along with the last reference to it. Uses an
+ * already loaded or preloaded image when available.
+ */
+QPixmap ImageCache::loadUncachedPixmap(const QString &fileName)
+{
+    auto pixmapIt = sLoadedPixmaps.find(fileName);
+    if (pixmapIt != sLoadedPixmaps.end())
+        return pixmapIt.value();
+
+    auto imageIt = sLoadedImages.find(fileName);
+    if (imageIt != sLoadedImages.end())
+        return QPixmap::fromImage(imageIt.value());
+
+    QImage image;
+    if (!takePreloadedImage(fileName, &image))
+        image = QImage(fileName);
+    return QPixmap::fromImage(image);
+}
+
+/**
+ * Returns the size of the image in the given file, reading only its header
+ * unless the image was already loaded. Returns an invalid size when the
+ * size can't be determined without decoding the image.
+ */
+QSize ImageCache::imageSize(const QString &fileName)
+{
+    auto it = sLoadedImages.find(fileName);
+    if (it != sLoadedImages.end())
+        return it.value().size();
+
+    return QImageReader(fileName).size();
+}
+
+/**
+ * Starts decoding the image in the given file on the global thread pool,
+ * so that a later call to loadImage or loadPixmap doesn't need to wait for
+ * it.
+ */
+void ImageCache::preloadImage(const QString &fileName)
+{
+    if (sLoadedImages.contains(fileName))
+        return;
+
+    PreloadedImages *preloaded = preloadedImages();
+    {
+        QMutexLocker locker(&preloaded->mutex);
+        if (preloaded->pending.contains(fileName) || preloaded->images.contains(fileName))
+            return;
+        preloaded->pending.insert(fileName);
+    }
+
+    QThreadPool::globalInstance()->start(new ImagePreloader(fileName));
+}
+
+/**
+ * Returns whether the image in the given file can be loaded without decoding
+ * it, because it is already loaded or has been preloaded.
+ */
+bool ImageCache::isImageAvailable(const QString &fileName)
+{
+    if (sLoadedPixmaps.contains(fileName) || sLoadedImages.contains(fileName))
+        return true;
+
+    PreloadedImages *preloaded = preloadedImages();
+    QMutexLocker locker(&preloaded->mutex);
+    return preloaded->images.contains(fileName);
+}
+
+/**
+ * Stops preloading the image in the given file and discards it if it was
+ * already decoded.
+ */
+void ImageCache::cancelPreload(const QString &fileName)
+{
+    takePreloadedImage(fileName, nullptr);
+}
+
+/**
+ * Sets the slot that is invoked with the file name of each preloaded image,
+ * once it is available. The \a member is called through a queued connection,
+ * so it runs on the thread of the \a receiver. Pass nullptr to unset it.
+ */
+void ImageCache::setPreloadReceiver(QObject *receiver, const char *member)
+{
+    PreloadedImages *preloaded = preloadedImages();
+    QMutexLocker locker(&preloaded->mutex);
+    preloaded->receiver = receiver;
+    preloaded->member = member;
+}
+
 static QVector<QPixmap> cutTilesImpl(const TilesheetParameters &p)
 {
     Q_ASSERT(p.tileWidth > 0 && p.tileHeight > 0);
@@ -114,6 +338,8 @@ void ImageCache::remove(const QString &fileName)
     sLoadedImages.remove(fileName);
     sLoadedPixmaps.remove(fileName);
 
+    cancelPreload(fileName);
+
     // Also remove any previously cut tiles
     QMutableHashIterator<TilesheetParameters, QVector<QPixmap>> it(sCutTiles);
     while (it.hasNext()) {
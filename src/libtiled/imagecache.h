@@ -37,6 +37,8 @@
 #include <QPixmap>
 #include <QString>
 
+class QObject;
+
 namespace Tiled {
 
 struct TILEDSHARED_EXPORT TilesheetParameters
@@ -58,6 +60,12 @@ class TILEDSHARED_EXPORT ImageCache
 public:
     static QImage loadImage(const QString &fileName);
     static QPixmap loadPixmap(const QString &fileName);
+    static QPixmap loadUncachedPixmap(const QString &fileName);
+    static QSize imageSize(const QString &fileName);
+    static void preloadImage(const QString &fileName);
+    static bool isImageAvailable(const QString &fileName);
+    static void cancelPreload(const QString &fileName);
+    static void setPreloadReceiver(QObject *receiver, const char *member);
     static QVector<QPixmap> cutTiles(const TilesheetParameters &parameters);
 
     static void remove(const QString &fileName);
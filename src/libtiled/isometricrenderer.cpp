@@ -34,6 +34,7 @@
 #include "tilelayer.h"
 #include "tileset.h"
 
+#include <QTextLayout>
 #include <QtMath>
 
 using namespace Tiled;
@@ -270,7 +271,7 @@ void IsometricRenderer::drawTileLayer(QPainter *painter,
     // Determine whether the current row is shifted half a tile to the right
     bool shifted = inUpperHalf ^ inLeftHalf;
 
-    CellRenderer renderer(painter);
+    CellRenderer renderer(painter, CellRenderer::OrthogonalCells, flags());
 
     for (int y = startPos.y() * 2; y - tileHeight * 2 < rect.bottom() * 2;
          y += tileHeight)
@@ -338,8 +339,8 @@ void IsometricRenderer::drawMapObject(QPainter *painter,
         const QSizeF size = object->size();
         const QPointF pos = pixelToScreenCoords(object->position());
 
-        CellRenderer(painter).render(cell, pos, size,
-                                     CellRenderer::BottomCenter);
+        CellRenderer(painter, CellRenderer::OrthogonalCells, flags())
+                .render(cell, pos, size, CellRenderer::BottomCenter);
 
         if (testFlag(ShowTileObjectOutlines)) {
             QPointF tileOffset;
@@ -361,13 +362,8 @@ void IsometricRenderer::drawMapObject(QPainter *painter,
         }
     } else if (object->shape() == MapObject::Text) {
         const QPointF pos = pixelToScreenCoords(object->position());
-        const auto& textData = object->textData();
-
-        painter->setFont(textData.font);
-        painter->setPen(textData.color);
-        painter->drawText(QRectF(pos, object->size()),
-                          textData.text,
-                          textData.textOption());
+        painter->setPen(object->textData().color);
+        object->textLayout().draw(painter, pos);
     } else {
         const qreal lineWidth = objectLineWidth();
         const qreal scale = painterScale();
@@ -509,6 +505,113 @@ void IsometricRenderer::drawMapObject(QPainter *painter,
     painter->restore();
 }
 
+void IsometricRenderer::drawTileObject(CellRenderer &cellRenderer,
+                                       const MapObject *object) const
+{
+    cellRenderer.render(object->cell(), pixelToScreenCoords(object->position()),
+                        object->size(), CellRenderer::BottomCenter);
+}
+
+bool IsometricRenderer::addObjectOutline(ObjectOutlines &outlines,
+                                         const MapObject *object,
+                                         const QTransform &transform) const
+{
+    if (!object->cell().isEmpty())
+        return false;
+
+    QPainterPath path;
+
+    switch (object->shape()) {
+    case MapObject::Rectangle: {
+        const QPolygonF polygon = pixelRectToScreenPolygon(object->bounds());
+        path.addPolygon(transform.map(polygon));
+        path.closeSubpath();
+        outlines.fills.append(path);
+        break;
+    }
+
+    case MapObject::Polygon:
+    case MapObject::Polyline: {
+        const QPointF &pos = object->position();
+        const QPolygonF polygon = object->polygon().translated(pos);
+        const QPolygonF screenPolygon = transform.map(pixelToScreenCoords(polygon));
+        if (screenPolygon.isEmpty())
+            return false;
+
+        path.addPolygon(screenPolygon);
+        if (object->shape() == MapObject::Polygon) {
+            path.closeSubpath();
+            outlines.fills.append(path);
+        }
+        outlines.markers.append(screenPolygon.first());
+        break;
+    }
+
+    case MapObject::Ellipse:    // drawn with its bounding diamond
+    case MapObject::Text:
+    case MapObject::Point:
+        return false;
+    }
+
+    outlines.lines.addPath(path);
+    return true;
+}
+
+void IsometricRenderer::drawObjectOutlines(QPainter *painter,
+                                           const ObjectOutlines &outlines,
+                                           const QColor &color) const
+{
+    if (outlines.isEmpty())
+        return;
+
+    const qreal lineWidth = objectLineWidth();
+    const qreal scale = painterScale();
+    const qreal shadowOffset = (lineWidth == 0 ? 1 : lineWidth) / scale;
+
+    QColor brushColor = color;
+    brushColor.setAlpha(50);
+    const QBrush brush(brushColor);
+
+    QPen pen(Qt::black);
+    pen.setCosmetic(true);
+    pen.setJoinStyle(Qt::RoundJoin);
+    pen.setCapStyle(Qt::RoundCap);
+    pen.setWidthF(lineWidth);
+
+    QPen colorPen(pen);
+    colorPen.setColor(color);
+
+    QPen thickPen(pen);
+    QPen thickColorPen(colorPen);
+    thickPen.setWidthF(thickPen.widthF() * 4);
+    thickColorPen.setWidthF(thickColorPen.widthF() * 4);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    // Draw the shadows
+    painter->setBrush(Qt::NoBrush);
+    painter->setPen(pen);
+    painter->drawPath(outlines.lines);
+    painter->setPen(thickPen);
+    painter->drawPoints(outlines.markers);
+
+    painter->translate(QPointF(0, -shadowOffset));
+
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(brush);
+    for (const QPainterPath &fill : outlines.fills)
+        painter->drawPath(fill);
+
+    painter->setBrush(Qt::NoBrush);
+    painter->setPen(colorPen);
+    painter->drawPath(outlines.lines);
+    painter->setPen(thickColorPen);
+    painter->drawPoints(outlines.markers);
+
+    painter->restore();
+}
+
 QPointF IsometricRenderer::pixelToTileCoords(qreal x, qreal y) const
 {
     const int tileHeight = map()->tileHeight();
@@ -66,6 +66,16 @@ public:
                        const MapObject *object,
                        const QColor &color) const override;
 
+    void drawTileObject(CellRenderer &cellRenderer,
+                        const MapObject *object) const override;
+
+    bool addObjectOutline(ObjectOutlines &outlines,
+                          const MapObject *object,
+                          const QTransform &transform) const override;
+    void drawObjectOutlines(QPainter *painter,
+                            const ObjectOutlines &outlines,
+                            const QColor &color) const override;
+
     using MapRenderer::pixelToTileCoords;
     QPointF pixelToTileCoords(qreal x, qreal y) const override;
 
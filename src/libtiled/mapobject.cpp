@@ -37,6 +37,7 @@
 #include "tile.h"
 
 #include <QFontMetricsF>
+#include <QTextLayout>
 #include <qmath.h>
 
 namespace Tiled {
@@ -100,7 +101,7 @@ MapObject::MapObject(const QString &name, const QString &type,
 int MapObject::index() const
 {
     if (mObjectGroup)
-        return mObjectGroup->objects().indexOf(const_cast<MapObject*>(this));
+        return mObjectGroup->objectIndex(this);
     return -1;
 }
 
@@ -123,6 +124,83 @@ const QString &MapObject::effectiveType() const
 void MapObject::setTextData(const TextData &textData)
 {
     mTextData = textData;
+    mTextLayoutCache.reset();
+}
+
+/**
+ * The laid out text of a text object, along with the object size for which
+ * it was laid out.
+ */
+struct MapObject::TextLayoutCache
+{
+    QSizeF size;
+    QTextLayout layout;
+};
+
+/**
+ * Lays out the text in the given \a textData to fit the given \a size, in
+ * the same way as QPainter::drawText would do with the same text options.
+ */
+static void layoutText(QTextLayout &layout,
+                       const TextData &textData,
+                       const QSizeF &size)
+{
+    QString text = textData.text;
+    text.replace(QLatin1Char('\n'), QChar::LineSeparator);
+
+    layout.setText(text);
+    layout.setFont(textData.font);
+    layout.setTextOption(textData.textOption());
+    layout.setCacheEnabled(true);
+
+    const qreal leading = QFontMetricsF(textData.font).leading();
+    qreal height = -leading;
+
+    layout.beginLayout();
+    while (true) {
+        QTextLine line = layout.createLine();
+        if (!line.isValid())
+            break;
+
+        line.setLineWidth(size.width());
+        height += leading;
+        line.setPosition(QPointF(0, height));
+        height += line.height();
+    }
+    layout.endLayout();
+
+    qreal offset = 0;
+    if (textData.alignment & Qt::AlignBottom)
+        offset = size.height() - height;
+    else if (textData.alignment & Qt::AlignVCenter)
+        offset = (size.height() - height) / 2;
+
+    if (offset != 0) {
+        for (int i = 0; i < layout.lineCount(); ++i) {
+            QTextLine line = layout.lineAt(i);
+            line.setPosition(line.position() + QPointF(0, offset));
+        }
+    }
+}
+
+/**
+ * Returns the text of this object laid out within its size, relative to the
+ * top-left of the text box. Can be drawn using QTextLayout::draw, which
+ * uses the pen of the painter as the text color.
+ *
+ * The layout is cached until the text data or the size of the object
+ * changes, to avoid shaping the text on every paint.
+ */
+const QTextLayout &MapObject::textLayout() const
+{
+    if (!mTextLayoutCache || mTextLayoutCache->size != mSize) {
+        auto cache = std::make_shared<TextLayoutCache>();
+        cache->size = mSize;
+        layoutText(cache->layout, mTextData, mSize);
+        mTextLayoutCache = std::move(cache);
+    }
+
+    return mTextLayoutCache->layout;
 }
 
 /**
@@ -267,7 +345,7 @@ void MapObject::setMapObjectProperty(Property property, const QVariant &value)
 {
     switch (property) {
     case NameProperty:          mName = value.toString(); break;
-    case TypeProperty:          mType = value.toString(); break;
+    case TypeProperty:          setType(value.toString()); break;
     case VisibleProperty:       mVisible = value.toBool(); break;
     case TextProperty:          mTextData.text = value.toString(); break;
     case TextFontProperty:      mTextData.font = value.value<QFont>(); break;
@@ -279,6 +357,20 @@ void MapObject::setMapObjectProperty(Property property, const QVariant &value)
     case CellProperty:          Q_ASSERT(false); break;
     case ShapeProperty:         mShape = value.value<Shape>(); break;
     }
+
+    switch (property) {
+    case TextProperty:
+    case TextFontProperty:
+    case TextAlignmentProperty:
+    case TextWordWrapProperty:
+        mTextLayoutCache.reset();
+        break;
+    default:
+        break;
+    }
+
+    if (property == SizeProperty || property == RotationProperty || property == ShapeProperty)
+        geometryChanged();
 }
 
 /**
@@ -348,6 +440,16 @@ void MapObject::copyPropertiesFrom(const MapObject *object)
     setObjectTemplate(object->objectTemplate());
 }
 
+/**
+ * Lets the object group know that the geometry of this object changed, so
+ * that it can keep its spatial index up to date.
+ */
+void MapObject::geometryChanged()
+{
+    if (mObjectGroup)
+        mObjectGroup->objectGeometryChanged(this);
+}
+
 const MapObject *MapObject::templateObject() const
 {
     if (mObjectTemplate)
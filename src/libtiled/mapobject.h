@@ -41,6 +41,10 @@
 #include <QString>
 #include <QTextOption>
 
+#include <memory>
+
+class QTextLayout;
+
 namespace Tiled {
 
 class MapRenderer;
@@ -161,6 +165,7 @@ public:
 
     const TextData &textData() const;
     void setTextData(const TextData &textData);
+    const QTextLayout &textLayout() const;
 
     const QPolygonF &polygon() const;
     void setPolygon(const QPolygonF &polygon);
@@ -217,6 +222,10 @@ public:
     void markAsTemplateBase();
 
 private:
+    struct TextLayoutCache;
+
+    void geometryChanged();
+
     void flipRectObject(const QTransform &flipTransform);
     void flipPolygonObject(const QTransform &flipTransform);
     void flipTileObject(const QTransform &flipTransform);
@@ -228,6 +237,7 @@ private:
     QPointF mPos;
     QSizeF mSize;
     TextData mTextData;
+    mutable std::shared_ptr<const TextLayoutCache> mTextLayoutCache;
     QPolygonF mPolygon;
     Cell mCell;
     const ObjectTemplate *mObjectTemplate;
@@ -294,7 +304,7 @@ inline const QPointF &MapObject::position() const
  * Sets the position of this object.
  */
 inline void MapObject::setPosition(const QPointF &pos)
-{ mPos = pos; }
+{ mPos = pos; geometryChanged(); }
 
 /**
  * Returns the x position of this object.
@@ -306,7 +316,7 @@ inline qreal MapObject::x() const
  * Sets the x position of this object.
  */
 inline void MapObject::setX(qreal x)
-{ mPos.setX(x); }
+{ mPos.setX(x); geometryChanged(); }
 
 /**
  * Returns the y position of this object.
@@ -318,7 +328,7 @@ inline qreal MapObject::y() const
  * Sets the x position of this object.
  */
 inline void MapObject::setY(qreal y)
-{ mPos.setY(y); }
+{ mPos.setY(y); geometryChanged(); }
 
 /**
  * Returns the size of this object.
@@ -330,7 +340,7 @@ inline const QSizeF &MapObject::size() const
  * Sets the size of this object.
  */
 inline void MapObject::setSize(const QSizeF &size)
-{ mSize = size; }
+{ mSize = size; geometryChanged(); }
 
 inline void MapObject::setSize(qreal width, qreal height)
 { setSize(QSizeF(width, height)); }
@@ -345,7 +355,7 @@ inline qreal MapObject::width() const
  * Sets the width of this object.
  */
 inline void MapObject::setWidth(qreal width)
-{ mSize.setWidth(width); }
+{ mSize.setWidth(width); geometryChanged(); }
 
 /**
  * Returns the height of this object.
@@ -357,7 +367,7 @@ inline qreal MapObject::height() const
  * Sets the height of this object.
  */
 inline void MapObject::setHeight(qreal height)
-{ mSize.setHeight(height); }
+{ mSize.setHeight(height); geometryChanged(); }
 
 /**
  * Sets the position and size of this object.
@@ -366,6 +376,7 @@ inline void MapObject::setBounds(const QRectF &bounds)
 {
     mPos = bounds.topLeft();
     mSize = bounds.size();
+    geometryChanged();
 }
 
 /**
@@ -388,7 +399,7 @@ inline const QPolygonF &MapObject::polygon() const
  * \sa setShape()
  */
 inline void MapObject::setPolygon(const QPolygonF &polygon)
-{ mPolygon = polygon; }
+{ mPolygon = polygon; geometryChanged(); }
 
 /**
  * Returns the shape of the object.
@@ -400,7 +411,7 @@ inline MapObject::Shape MapObject::shape() const
  * Sets the shape of the object.
  */
 inline void MapObject::setShape(MapObject::Shape shape)
-{ mShape = shape; }
+{ mShape = shape; geometryChanged(); }
 
 /**
  * Returns true if this object has a width and height.
@@ -445,7 +456,7 @@ inline const Cell &MapObject::cell() const
  * \warning The object shape is ignored for tile objects!
  */
 inline void MapObject::setCell(const Cell &cell)
-{ mCell = cell; }
+{ mCell = cell; geometryChanged(); }
 
 inline const ObjectTemplate *MapObject::objectTemplate() const
 { return mObjectTemplate; }
@@ -476,7 +487,7 @@ inline qreal MapObject::rotation() const
  * Sets the rotation of the object in degrees clockwise.
  */
 inline void MapObject::setRotation(qreal rotation)
-{ mRotation = rotation; }
+{ mRotation = rotation; geometryChanged(); }
 
 inline bool MapObject::isVisible() const
 { return mVisible; }
@@ -52,6 +52,7 @@
 #include <QVector>
 #include <QXmlStreamReader>
 
+#include <functional>
 #include <memory>
 
 using namespace Tiled;
@@ -69,7 +70,8 @@ class MapReaderPrivate
 public:
     explicit MapReaderPrivate(MapReader *mapReader):
         p(mapReader),
-        mReadingExternalTileset(false)
+        mReadingExternalTileset(false),
+        mDeferLoading(false)
     {}
 
     Map *readMap(QIODevice *device, const QString &path);
@@ -80,10 +82,15 @@ public:
 
     QString errorString() const;
 
+    void loadDeferred(Map &map);
+
 private:
     void readUnknownElement();
 
     Map *readMap();
+    void finishMap(Map &map);
+
+    bool isDeferringLoads() const;
 
     SharedTileset readTileset();
     void readTilesetTile(Tileset &tileset);
@@ -143,8 +150,12 @@ private:
     QDir mPath;
     std::unique_ptr<Map> mMap;
     GidMapper mGidMapper;
+    PropertiesPool mPropertiesPool;
     bool mReadingExternalTileset;
 
+    bool mDeferLoading;
+    QVector<std::function<void (Map &)>> mDeferredLoads;
+
     QXmlStreamReader xml;
 };
 
@@ -155,6 +166,7 @@ Map *MapReaderPrivate::readMap(QIODevice *device, const QString &path)
 {
     mError.clear();
     mPath.setPath(path);
+    mDeferredLoads.clear();
     Map *map = nullptr;
 
     xml.setDevice(device);
@@ -304,32 +316,67 @@ Map *MapReaderPrivate::readMap()
     // Clean up in case of error
     if (xml.hasError()) {
         mMap.reset();
-    } else {
-        // Try to load the tileset images for embedded tilesets
-        auto tilesets = mMap->tilesets();
-        for (SharedTileset &tileset : tilesets) {
-            if (!tileset->isCollection() && tileset->fileName().isEmpty())
-                tileset->loadImage();
-        }
+        mDeferredLoads.clear();
+    } else if (!mDeferLoading) {
+        finishMap(*mMap);
+    }
 
-        // Fix up sizes of tile objects. This is for backwards compatibility.TiledĴСΪݡ
-        LayerIterator iterator(mMap.get());
-        while (Layer *layer = iterator.next()) {
-            if (ObjectGroup *objectGroup = layer->asObjectGroup()) {
-                for (MapObject *object : *objectGroup) {
-                    if (const Tile *tile = object->cell().tile()) {
-                        const QSizeF tileSize = tile->size();
-                        if (object->width() == 0)
-                            object->setWidth(tileSize.width());
-                        if (object->height() == 0)
-                            object->setHeight(tileSize.height());
-                    }
+    return mMap.release();
+}
+
+/**
+ * Returns whether loads that need to happen on the main thread are currently
+ * being deferred, which is only done while reading a map.
+ */
+bool MapReaderPrivate::isDeferringLoads() const
+{
+    return mDeferLoading && mMap;
+}
+
+void MapReaderPrivate::loadDeferred(Map &map)
+{
+    // The tilesets could not be added to the manager on a worker thread
+    const auto tilesets = map.tilesets();
+    for (const SharedTileset &tileset : tilesets)
+        TilesetManager::instance()->addTileset(tileset.data());
+
+    const auto deferredLoads = std::move(mDeferredLoads);
+    mDeferredLoads.clear();
+
+    for (const auto &load : deferredLoads)
+        load(map);
+
+    finishMap(map);
+}
+
+/**
+ * Loads the images of the embedded tilesets and updates the tile objects,
+ * once all tilesets have been loaded.
+ */
+void MapReaderPrivate::finishMap(Map &map)
+{
+    // Try to load the tileset images for embedded tilesets
+    auto tilesets = map.tilesets();
+    for (SharedTileset &tileset : tilesets) {
+        if (!tileset->isCollection() && tileset->fileName().isEmpty())
+            tileset->loadImage();
+    }
+
+    // Fix up sizes of tile objects. This is for backwards compatibility.TiledĴСΪݡ
+    LayerIterator iterator(&map);
+    while (Layer *layer = iterator.next()) {
+        if (ObjectGroup *objectGroup = layer->asObjectGroup()) {
+            for (MapObject *object : *objectGroup) {
+                if (const Tile *tile = object->cell().tile()) {
+                    const QSizeF tileSize = tile->size();
+                    if (object->width() == 0)
+                        object->setWidth(tileSize.width());
+                    if (object->height() == 0)
+                        object->setHeight(tileSize.height());
                 }
             }
         }
     }
-
-    return mMap.release();
 }
 
 SharedTileset MapReaderPrivate::readTileset()
@@ -398,8 +445,26 @@ SharedTileset MapReaderPrivate::readTileset()
         }
     } else { // External tileset
         const QString absoluteSource = p->resolveReference(source, mPath);
-        QString error;
-        tileset = p->readExternalTileset(absoluteSource, &error);
+
+        if (isDeferringLoads()) {
+            // Use a placeholder until the tileset is loaded. It has no file
+            // name yet, so that it isn't mistaken for the actual tileset.
+            tileset = Tileset::create(QFileInfo(absoluteSource).completeBaseName(), 32, 32);
+
+            const SharedTileset placeholder = tileset;
+            mDeferredLoads.append([this, placeholder, absoluteSource] (Map &map) {
+                QString error;
+                if (SharedTileset tileset = p->readExternalTileset(absoluteSource, &error)) {
+                    map.replaceTileset(placeholder, tileset);
+                } else {
+                    placeholder->setFileName(absoluteSource);
+                    placeholder->setStatus(LoadingError);
+                }
+            });
+        } else {
+            QString error;
+            tileset = p->readExternalTileset(absoluteSource, &error);
+        }
 
         if (!tileset) {
             // Insert a placeholder to allow the map to load
@@ -417,6 +482,23 @@ SharedTileset MapReaderPrivate::readTileset()
     return tileset;
 }
 
+/**
+ * Sets the image of a tile in a collection tileset. Returns false when an
+ * embedded image could not be read.
+ */
+static bool loadTileImage(Tileset &tileset, Tile *tile,
+                          const ImageReference &imageReference)
+{
+    // External images are only loaded once they are needed
+    if (tileset.setPendingTileImage(tile, imageReference.source))
+        return true;
+
+    const QPixmap image = imageReference.create();
+    tileset.setTileImage(tile, image, imageReference.source);
+
+    return !image.isNull() || !imageReference.source.isEmpty();
+}
+
 void MapReaderPrivate::readTilesetTile(Tileset &tileset)
 {
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("tile"));
@@ -456,12 +538,14 @@ void MapReaderPrivate::readTilesetTile(Tileset &tileset)
         } else if (xml.name() == QLatin1String("image")) {
             ImageReference imageReference = readImage();
             if (imageReference.hasImage()) {
-                QPixmap image = imageReference.create();
-                if (image.isNull()) {
-                    if (imageReference.source.isEmpty())
-                        xml.raiseError(tr("Error reading embedded image for tile %1").arg(id));
+                if (isDeferringLoads()) {
+                    Tileset *tilesetPtr = &tileset;
+                    mDeferredLoads.append([tilesetPtr, tile, imageReference] (Map &) {
+                        loadTileImage(*tilesetPtr, tile, imageReference);
+                    });
+                } else if (!loadTileImage(tileset, tile, imageReference)) {
+                    xml.raiseError(tr("Error reading embedded image for tile %1").arg(id));
                 }
-                tileset.setTileImage(tile, image, imageReference.source);
             }
         } else if (xml.name() == QLatin1String("objectgroup")) {
             ObjectGroup *objectGroup = readObjectGroup();
@@ -1015,7 +1099,14 @@ void MapReaderPrivate::readImageLayerImage(ImageLayer &imageLayer)
 
     QUrl sourceUrl = toUrl(source, mPath);
 
-    imageLayer.loadFromImage(sourceUrl);
+    if (isDeferringLoads()) {
+        ImageLayer *imageLayerPtr = &imageLayer;
+        mDeferredLoads.append([imageLayerPtr, sourceUrl] (Map &) {
+            imageLayerPtr->loadFromImage(sourceUrl);
+        });
+    } else {
+        imageLayer.loadFromImage(sourceUrl);
+    }
 
     xml.skipCurrentElement();
 }
@@ -1043,8 +1134,17 @@ MapObject *MapReaderPrivate::readObject()
 
     if (!templateFileName.isEmpty()) { // This object is a template instance
         const QString absoluteFileName = p->resolveReference(templateFileName, mPath);
-        auto objectTemplate = TemplateManager::instance()->loadObjectTemplate(absoluteFileName);
-        object->setObjectTemplate(objectTemplate);
+
+        if (isDeferringLoads()) {
+            mDeferredLoads.append([object, absoluteFileName] (Map &) {
+                auto objectTemplate = TemplateManager::instance()->loadObjectTemplate(absoluteFileName);
+                object->setObjectTemplate(objectTemplate);
+                object->syncWithTemplate();
+            });
+        } else {
+            auto objectTemplate = TemplateManager::instance()->loadObjectTemplate(absoluteFileName);
+            object->setObjectTemplate(objectTemplate);
+        }
     }
 
     object->setId(id);
@@ -1259,7 +1359,7 @@ Properties MapReaderPrivate::readProperties()
             readUnknownElement();
     }
 
-    return properties;
+    return mPropertiesPool.share(properties);
 }
 
 void MapReaderPrivate::readProperty(Properties *properties)
@@ -1289,7 +1389,7 @@ void MapReaderPrivate::readProperty(Properties *properties)
         variant = fromExportValue(variant, type, mPath);
     }
 
-    properties->insert(propertyName, variant);
+    properties->insert(mPropertiesPool.name(propertyName), variant);
 }
 
 
@@ -1358,6 +1458,16 @@ ObjectTemplate *MapReader::readObjectTemplate(const QString &fileName)
     return objectTemplate;
 }
 
+void MapReader::setDeferLoading(bool defer)
+{
+    d->mDeferLoading = defer;
+}
+
+void MapReader::loadDeferred(Map *map)
+{
+    d->loadDeferred(*map);
+}
+
 QString MapReader::errorString() const
 {
     return d->errorString();
@@ -95,6 +95,22 @@ public:
      */
     QString errorString() const;
 
+    /**
+     * Sets whether loading the external tilesets, object templates and
+     * images of a map is deferred until loadDeferred() is called. These are
+     * shared with the rest of the application and can only be loaded on the
+     * main thread, so this allows the map itself to be read on a worker
+     * thread. Only affects readMap().
+     */
+    void setDeferLoading(bool defer);
+
+    /**
+     * Loads the external tilesets, object templates and images of a \a map
+     * that was read with deferred loading enabled. Needs to be called on the
+     * main thread, before the map is used.
+     */
+    void loadDeferred(Map *map);
+
     ObjectTemplate *readObjectTemplate(QIODevice *device, const QString &path = QString());
     ObjectTemplate *readObjectTemplate(const QString &fileName);
 
@@ -114,6 +114,25 @@ QPainterPath MapRenderer::pointShape(const MapObject *object) const
     return path;
 }
 
+bool MapRenderer::addObjectOutline(ObjectOutlines &outlines,
+                                   const MapObject *object,
+                                   const QTransform &transform) const
+{
+    Q_UNUSED(outlines)
+    Q_UNUSED(object)
+    Q_UNUSED(transform)
+    return false;
+}
+
+void MapRenderer::drawObjectOutlines(QPainter *painter,
+                                     const ObjectOutlines &outlines,
+                                     const QColor &color) const
+{
+    Q_UNUSED(painter)
+    Q_UNUSED(outlines)
+    Q_UNUSED(color)
+}
+
 void MapRenderer::setFlag(RenderFlag flag, bool enabled)
 {
     if (enabled)
@@ -192,11 +211,14 @@ static bool hasOpenGLEngine(const QPainter *painter)
             type == QPaintEngine::OpenGL2);
 }
 
-CellRenderer::CellRenderer(QPainter *painter, const CellType cellType)
+CellRenderer::CellRenderer(QPainter *painter,
+                           const CellType cellType,
+                           RenderFlags flags)
     : mPainter(painter)
     , mTile(nullptr)
     , mIsOpenGL(hasOpenGLEngine(painter))
     , mCellType(cellType)
+    , mFlags(flags)
 {
 }
 
@@ -216,6 +238,11 @@ void CellRenderer::render(const Cell &cell, const QPointF &pos, const QSizeF &si
     if (tile)
         tile = tile->currentFrameTile();
 
+    // Skip tiles whose image is still being decoded. The tileset is
+    // repainted once it is available.
+    if (tile && mFlags.testFlag(LoadImagesInBackground) && !tile->requestImage())
+        return;
+
     if (!tile || tile->image().isNull()) {
         QRectF target { pos - QPointF(0, size.height()), size };
         if (origin == BottomCenter)
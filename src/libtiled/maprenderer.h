@@ -35,15 +35,18 @@
 namespace Tiled {
 
 class Cell;
+class CellRenderer;
 class Layer;
 class Map;
 class MapObject;
 class Tile;
+struct ObjectOutlines;
 class TileLayer;
 class ImageLayer;
 
 enum RenderFlag {
-    ShowTileObjectOutlines = 0x1
+    ShowTileObjectOutlines = 0x1,
+    LoadImagesInBackground = 0x2
 };
 
 Q_DECLARE_FLAGS(RenderFlags, RenderFlag)
@@ -144,6 +147,34 @@ public:
                                const MapObject *object,
                                const QColor &color) const = 0;
 
+    /**
+     * Draws the tile of the given tile \a object using the \a cellRenderer.
+     * Sharing a cell renderer allows the tiles of many objects to be drawn
+     * in batches.
+     *
+     * Unlike drawMapObject(), this does not apply the rotation of the object
+     * and does not draw tile object outlines.
+     */
+    virtual void drawTileObject(CellRenderer &cellRenderer,
+                                const MapObject *object) const = 0;
+
+    /**
+     * Adds the outline of the shape \a object, mapped by \a transform, to
+     * \a outlines. Returns false when the object can't be drawn as part of
+     * such a batch, in which case it should be drawn with drawMapObject().
+     */
+    virtual bool addObjectOutline(ObjectOutlines &outlines,
+                                  const MapObject *object,
+                                  const QTransform &transform) const;
+
+    /**
+     * Draws the \a outlines collected by addObjectOutline() in the given
+     * \a color, the way drawMapObject() draws each of those objects.
+     */
+    virtual void drawObjectOutlines(QPainter *painter,
+                                    const ObjectOutlines &outlines,
+                                    const QColor &color) const;
+
     /**
      * Draws the a pin in the given \a color using the \a painter.
      */
@@ -286,7 +317,9 @@ public:
         HexagonalCells
     };
 
-    explicit CellRenderer(QPainter *painter, CellType cellType = OrthogonalCells);
+    explicit CellRenderer(QPainter *painter,
+                          CellType cellType = OrthogonalCells,
+                          RenderFlags flags = RenderFlags());
 
     ~CellRenderer() { flush(); }
 
@@ -299,6 +332,21 @@ private:
     QVector<QPainter::PixmapFragment> mFragments;
     const bool mIsOpenGL;
     const CellType mCellType;
+    const RenderFlags mFlags;
+};
+
+
+/**
+ * The outlines of a number of shape objects that are drawn in the same
+ * color, collected by MapRenderer::addObjectOutline().
+ */
+struct ObjectOutlines
+{
+    QVector<QPainterPath> fills;    // Filled areas, drawn one by one
+    QPainterPath lines;             // All outlines, drawn in one go
+    QPolygonF markers;              // Start points of polygons and polylines
+
+    bool isEmpty() const { return lines.isEmpty(); }
 };
 
 } // namespace Tiled
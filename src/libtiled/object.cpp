@@ -34,6 +34,8 @@
 namespace Tiled {
 
 ObjectTypes Object::mObjectTypes;
+QHash<QString, int> Object::mObjectTypeIndices;
+QHash<QString, int> Object::mLowerCaseObjectTypeIndices;
 
 Object::~Object()
 {}
@@ -83,20 +85,82 @@ QVariant Object::inheritedProperty(const QString &name) const
         return QVariant();
     }
 
-    if (!objectType.isEmpty()) {
-        for (const ObjectType &type : mObjectTypes) {
-            if (type.name == objectType)
-                if (type.defaultProperties.contains(name))
-                    return type.defaultProperties.value(name);
-        }
-    }
+    if (!objectType.isEmpty())
+        if (const ObjectType *type = Object::objectType(objectType))
+            return type->defaultProperties.value(name);
 
     return QVariant();
 }
 
+/**
+ * Returns the properties this object inherits, not including its own
+ * properties. See inheritedProperty() for the places they are inherited from.
+ *
+ * The result is not cached, since it depends on the object types and on
+ * other objects. Callers that need it repeatedly should keep a copy.
+ */
+Properties Object::inheritedProperties() const
+{
+    Properties properties;
+    QString objectType;
+    const Tile *tile = nullptr;
+    const MapObject *templateObject = nullptr;
+
+    switch (typeId()) {
+    case MapObjectType: {
+        auto mapObject = static_cast<const MapObject*>(this);
+        objectType = mapObject->type();
+        templateObject = mapObject->templateObject();
+        tile = mapObject->cell().tile();
+
+        if (tile && objectType.isEmpty())
+            objectType = tile->type();
+        break;
+    }
+    case TileType:
+        objectType = static_cast<const Tile*>(this)->type();
+        break;
+    default:
+        return properties;
+    }
+
+    // Merged in order of increasing precedence
+    if (!objectType.isEmpty())
+        if (const ObjectType *type = Object::objectType(objectType))
+            properties.merge(type->defaultProperties);
+
+    if (tile)
+        properties.merge(tile->properties());
+
+    if (templateObject)
+        properties.merge(templateObject->properties());
+
+    return properties;
+}
+
 void Object::setObjectTypes(const ObjectTypes &objectTypes)
 {
     mObjectTypes = objectTypes;
+    mObjectTypeIndices.clear();
+    mLowerCaseObjectTypeIndices.clear();
+
+    // The first type with a given name takes precedence
+    for (int i = mObjectTypes.size() - 1; i >= 0; --i) {
+        const QString &name = mObjectTypes.at(i).name;
+        mObjectTypeIndices.insert(name, i);
+        mLowerCaseObjectTypeIndices.insert(name.toLower(), i);
+    }
+}
+
+/**
+ * Returns the object type with the given \a name, or nullptr when there is
+ * no such type.
+ */
+const ObjectType *Object::objectType(const QString &name, Qt::CaseSensitivity cs)
+{
+    const int index = cs == Qt::CaseSensitive ? mObjectTypeIndices.value(name, -1)
+                                              : mLowerCaseObjectTypeIndices.value(name.toLower(), -1);
+    return index >= 0 ? &mObjectTypes.at(index) : nullptr;
 }
 
 } // namespace Tiled
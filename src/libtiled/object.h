@@ -31,6 +31,8 @@
 #include "properties.h"
 #include "objecttypes.h"
 
+#include <QHash>
+
 namespace Tiled {
 
 /**κοԱĻ
@@ -96,6 +98,7 @@ public:
     { return mProperties.value(name); }
 
     QVariant inheritedProperty(const QString &name) const;
+    Properties inheritedProperties() const;
 
     /**
      * Returns the value of the object's \a name property, as a string.
@@ -129,12 +132,16 @@ public:
     static void setObjectTypes(const ObjectTypes &objectTypes);
     static const ObjectTypes &objectTypes()
     { return mObjectTypes; }
+    static const ObjectType *objectType(const QString &name,
+                                        Qt::CaseSensitivity cs = Qt::CaseSensitive);
 
 private:
     const TypeId mTypeId;
     Properties mProperties;
 
     static ObjectTypes mObjectTypes;
+    static QHash<QString, int> mObjectTypeIndices;
+    static QHash<QString, int> mLowerCaseObjectTypeIndices;
 };
 
 
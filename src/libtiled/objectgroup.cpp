@@ -35,10 +35,244 @@
 #include "mapobject.h"
 #include "tile.h"
 
+#include <QHash>
+#include <QVector>
+#include <qmath.h>
+
+#include <algorithm>
 #include <cmath>
+#include <functional>
 
 using namespace Tiled;
 
+namespace Tiled {
+
+/**
+ * A uniform grid over the objects in an object group, used to quickly find
+ * the objects in a certain area.
+ *
+ * Each object is stored in all cells overlapped by a generous approximation
+ * of its bounds. Objects that would cover too many cells are kept in a
+ * separate list that is always checked.
+ */
+class ObjectGroupIndex
+{
+public:
+    explicit ObjectGroupIndex(qreal scale);
+
+    qreal scale() const { return mScale; }
+
+    void insert(MapObject *object);
+    void remove(MapObject *object);
+    void update(MapObject *object);
+
+    void query(const QRectF &rect, QList<MapObject*> &objects) const;
+
+private:
+    struct Entry
+    {
+        QRectF bounds;
+        QRect cells;    // null for large objects
+    };
+
+    QRectF indexBounds(const MapObject *object) const;
+
+    void addToCells(MapObject *object, const QRect &cells);
+    void removeFromCells(MapObject *object, const QRect &cells);
+
+    const qreal mScale;
+    QHash<QPoint, QVector<MapObject*>> mCells;
+    QHash<MapObject*, Entry> mEntries;
+    QVector<MapObject*> mLargeObjects;
+};
+
+} // namespace Tiled
+
+static const int IndexCellSize = 256;
+static const int MaxIndexCellsPerObject = 64;
+
+static int indexCellCoordinate(qreal value)
+{
+    // Clamp to avoid overflow for objects placed very far away
+    return static_cast<int>(qBound<qreal>(-1e9, std::floor(value / IndexCellSize), 1e9));
+}
+
+static QRect indexCellsCovering(const QRectF &rect)
+{
+    return QRect(QPoint(indexCellCoordinate(rect.left()),
+                        indexCellCoordinate(rect.top())),
+                 QPoint(indexCellCoordinate(rect.right()),
+                        indexCellCoordinate(rect.bottom())));
+}
+
+/**
+ * Like QRectF::intersects, but also true for touching and empty rectangles,
+ * so that it can be used for looking up points.
+ */
+static bool touches(const QRectF &a, const QRectF &b)
+{
+    return a.left() <= b.right() && b.left() <= a.right() &&
+            a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+/**
+ * Returns the scale to apply to the object bounds stored in the index.
+ *
+ * Tile and text objects have their size in screen coordinates, which may
+ * stretch by up to this factor when mapped to pixel coordinates on isometric
+ * maps.
+ */
+static qreal indexScale(const Map *map)
+{
+    if (map && map->orientation() == Map::Isometric && map->tileWidth() > 0)
+        return M_SQRT2 * qMax<qreal>(1.0, qreal(map->tileHeight()) / map->tileWidth());
+    return 1.0;
+}
+
+ObjectGroupIndex::ObjectGroupIndex(qreal scale)
+    : mScale(scale)
+{
+}
+
+void ObjectGroupIndex::insert(MapObject *object)
+{
+    Entry entry;
+    entry.bounds = indexBounds(object);
+    entry.cells = indexCellsCovering(entry.bounds);
+
+    if (qint64(entry.cells.width()) * entry.cells.height() > MaxIndexCellsPerObject) {
+        entry.cells = QRect();
+        mLargeObjects.append(object);
+    } else {
+        addToCells(object, entry.cells);
+    }
+
+    mEntries.insert(object, entry);
+}
+
+void ObjectGroupIndex::remove(MapObject *object)
+{
+    const auto it = mEntries.find(object);
+    if (it == mEntries.end())
+        return;
+
+    if (it->cells.isNull())
+        mLargeObjects.removeOne(object);
+    else
+        removeFromCells(object, it->cells);
+
+    mEntries.erase(it);
+}
+
+void ObjectGroupIndex::update(MapObject *object)
+{
+    const auto it = mEntries.find(object);
+    if (it == mEntries.end())
+        return;
+
+    const QRectF bounds = indexBounds(object);
+    const QRect cells = indexCellsCovering(bounds);
+
+    // Common case of small changes that stay within the same cells
+    if (!it->cells.isNull() && it->cells == cells) {
+        it->bounds = bounds;
+        return;
+    }
+
+    remove(object);
+    insert(object);
+}
+
+void ObjectGroupIndex::query(const QRectF &rect, QList<MapObject*> &objects) const
+{
+    const QRect cells = indexCellsCovering(rect);
+
+    auto addIfTouching = [&] (MapObject *object) {
+        if (touches(mEntries.value(object).bounds, rect))
+            objects.append(object);
+    };
+
+    if (qint64(cells.width()) * cells.height() > mCells.size()) {
+        for (auto it = mCells.begin(), end = mCells.end(); it != end; ++it)
+            if (cells.contains(it.key()))
+                for (MapObject *object : it.value())
+                    addIfTouching(object);
+    } else {
+        for (int y = cells.top(); y <= cells.bottom(); ++y) {
+            for (int x = cells.left(); x <= cells.right(); ++x) {
+                const auto it = mCells.find(QPoint(x, y));
+                if (it != mCells.end())
+                    for (MapObject *object : it.value())
+                        addIfTouching(object);
+            }
+        }
+    }
+
+    for (MapObject *object : mLargeObjects)
+        addIfTouching(object);
+
+    // Objects overlapping multiple cells may have been found several times
+    std::sort(objects.begin(), objects.end(), [] (MapObject *a, MapObject *b) {
+        if (a->id() != b->id())
+            return a->id() < b->id();
+        return std::less<MapObject*>()(a, b);
+    });
+    objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+}
+
+/**
+ * Returns a square around the position of the object, which contains the
+ * object regardless of its alignment and rotation.
+ */
+QRectF ObjectGroupIndex::indexBounds(const MapObject *object) const
+{
+    const QSizeF &size = object->size();
+    qreal radius = std::hypot(size.width(), size.height());
+
+    for (const QPointF &point : object->polygon())
+        radius = qMax(radius, std::hypot(point.x(), point.y()));
+
+    if (const Tile *tile = object->cell().tile()) {
+        const QSize tileSize = tile->size();
+        qreal scale = 1.0;
+        if (tileSize.width() > 0 && tileSize.height() > 0) {
+            scale = qMax(scale, qMax(size.width() / tileSize.width(),
+                                     size.height() / tileSize.height()));
+        }
+
+        radius = qMax(radius, std::hypot(tileSize.width(), tileSize.height()));
+        radius += tile->offset().manhattanLength() * scale;
+    }
+
+    radius *= mScale;
+
+    const QPointF &pos = object->position();
+    return QRectF(pos.x() - radius, pos.y() - radius, radius * 2, radius * 2);
+}
+
+void ObjectGroupIndex::addToCells(MapObject *object, const QRect &cells)
+{
+    for (int y = cells.top(); y <= cells.bottom(); ++y)
+        for (int x = cells.left(); x <= cells.right(); ++x)
+            mCells[QPoint(x, y)].append(object);
+}
+
+void ObjectGroupIndex::removeFromCells(MapObject *object, const QRect &cells)
+{
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            const auto it = mCells.find(QPoint(x, y));
+            if (it == mCells.end())
+                continue;
+
+            it->removeOne(object);
+            if (it->isEmpty())
+                mCells.erase(it);
+        }
+    }
+}
+
+
 ObjectGroup::ObjectGroup()
     : ObjectGroup(QString(), 0, 0)
 {
@@ -61,23 +295,27 @@ void ObjectGroup::addObject(MapObject *object)
     object->setObjectGroup(this);
     if (mMap && object->id() == 0)
         object->setId(mMap->takeNextObjectId());
+    if (mIndex)
+        mIndex->insert(object);
 }
 
 void ObjectGroup::insertObject(int index, MapObject *object)
 {
     mObjects.insert(index, object);
+    mObjectIndicesValid = qMin(mObjectIndicesValid, index);
     object->setObjectGroup(this);
     if (mMap && object->id() == 0)
         object->setId(mMap->takeNextObjectId());
+    if (mIndex)
+        mIndex->insert(object);
 }
 
 int ObjectGroup::removeObject(MapObject *object)
 {
-    const int index = mObjects.indexOf(object);
+    const int index = objectIndex(object);
     Q_ASSERT(index != -1);
 
-    mObjects.removeAt(index);
-    object->setObjectGroup(nullptr);
+    removeObjectAt(index);
     return index;
 }
 
@@ -85,6 +323,11 @@ void ObjectGroup::removeObjectAt(int index)
 {
     MapObject *object = mObjects.takeAt(index);
     object->setObjectGroup(nullptr);
+    if (mIndex)
+        mIndex->remove(object);
+
+    mObjectIndices.remove(object);
+    mObjectIndicesValid = qMin(mObjectIndicesValid, index);
 }
 
 void ObjectGroup::moveObjects(int from, int to, int count)
@@ -107,6 +350,24 @@ void ObjectGroup::moveObjects(int from, int to, int count)
 
     for (int i = 0; i < count; ++i)
         mObjects.insert(to + i, movingObjects.at(i));
+
+    mObjectIndicesValid = qMin(mObjectIndicesValid, qMin(from, to));
+}
+
+/**
+ * Returns the index of \a object in this object group, or -1 when it is not
+ * part of this group.
+ *
+ * The indexes are remembered and only recalculated from the first position
+ * that changed since the last call, so this is usually constant time.
+ */
+int ObjectGroup::objectIndex(const MapObject *object) const
+{
+    for (int i = mObjectIndicesValid; i < mObjects.size(); ++i)
+        mObjectIndices.insert(mObjects.at(i), i);
+    mObjectIndicesValid = mObjects.size();
+
+    return mObjectIndices.value(object, -1);
 }
 
 QRectF ObjectGroup::objectsBoundingRect() const
@@ -117,6 +378,41 @@ QRectF ObjectGroup::objectsBoundingRect() const
     return boundingRect;
 }
 
+QList<MapObject*> ObjectGroup::objectsInRect(const QRectF &rect) const
+{
+    QList<MapObject*> objects;
+    index()->query(rect, objects);
+    return objects;
+}
+
+QList<MapObject*> ObjectGroup::objectsAt(const QPointF &pos) const
+{
+    return objectsInRect(QRectF(pos, QSizeF(0, 0)));
+}
+
+void ObjectGroup::objectGeometryChanged(MapObject *object)
+{
+    if (mIndex)
+        mIndex->update(object);
+}
+
+/**
+ * Returns the spatial index, creating it when it doesn't exist yet or when
+ * it was built for a different map orientation or tile size.
+ */
+ObjectGroupIndex *ObjectGroup::index() const
+{
+    const qreal scale = indexScale(mMap);
+
+    if (!mIndex || mIndex->scale() != scale) {
+        mIndex.reset(new ObjectGroupIndex(scale));
+        for (MapObject *object : mObjects)
+            mIndex->insert(object);
+    }
+
+    return mIndex.get();
+}
+
 bool ObjectGroup::isEmpty() const
 {
     return mObjects.isEmpty();
@@ -35,12 +35,16 @@
 #include "layer.h"
 
 #include <QColor>
+#include <QHash>
 #include <QList>
 #include <QMetaType>
 
+#include <memory>
+
 namespace Tiled {
 
 class MapObject;
+class ObjectGroupIndex;
 
 /**
  * A group of objects on a map.ͼϵһ
@@ -81,6 +85,8 @@ public:
      */
     MapObject *objectAt(int index) const { return mObjects.at(index); }
 
+    int objectIndex(const MapObject *object) const;
+
     /**
      * Adds an object to this object group.
      */
@@ -125,6 +131,33 @@ public:
      */
     QRectF objectsBoundingRect() const;
 
+    /**
+     * Returns the objects that may intersect the given \a rect, in pixel
+     * coordinates. The returned objects are sorted by their ID.
+     *
+     * The bounds used for this lookup are generous, taking into account
+     * rotation, alignment and tile size, so callers needing exact results
+     * should check the shape of the returned objects.
+     *
+     * This uses a spatial index that is created when first needed and then
+     * kept up to date as objects are added, removed or change geometry.
+     */
+    QList<MapObject*> objectsInRect(const QRectF &rect) const;
+
+    /**
+     * Returns the objects that may contain the given \a pos, in pixel
+     * coordinates.
+     *
+     * \sa objectsInRect()
+     */
+    QList<MapObject*> objectsAt(const QPointF &pos) const;
+
+    /**
+     * Updates the spatial index for the given \a object. Called by MapObject
+     * when its geometry changes.
+     */
+    void objectGeometryChanged(MapObject *object);
+
     /**Ƿκζ
      * Returns whether this object group contains any objects.
      */
@@ -185,9 +218,16 @@ protected:
     ObjectGroup *initializeClone(ObjectGroup *clone) const;
 
 private:
+    ObjectGroupIndex *index() const;
+
     QList<MapObject*> mObjects;
     QColor mColor;
     DrawOrder mDrawOrder;
+    mutable std::unique_ptr<ObjectGroupIndex> mIndex;
+
+    // Object positions, valid for the first mObjectIndicesValid objects
+    mutable QHash<const MapObject*, int> mObjectIndices;
+    mutable int mObjectIndicesValid = 0;
 };
 
 
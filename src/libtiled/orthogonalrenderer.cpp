@@ -34,6 +34,7 @@
 #include "tilelayer.h"
 #include "tileset.h"
 
+#include <QTextLayout>
 #include <QtCore/qmath.h>
 
 using namespace Tiled;
@@ -291,7 +292,7 @@ void OrthogonalRenderer::drawTileLayer(QPainter *painter,
     const QTransform savedTransform = painter->transform();
     painter->translate(layerPos);
 
-    CellRenderer renderer(painter);
+    CellRenderer renderer(painter, CellRenderer::OrthogonalCells, flags());
 
     Map::RenderOrder renderOrder = map()->renderOrder();
 
@@ -371,8 +372,8 @@ void OrthogonalRenderer::drawMapObject(QPainter *painter,
 
     if (!cell.isEmpty()) {
         const QSizeF size = object->size();
-        CellRenderer(painter).render(cell, QPointF(), size,
-                                     CellRenderer::BottomLeft);
+        CellRenderer(painter, CellRenderer::OrthogonalCells, flags())
+                .render(cell, QPointF(), size, CellRenderer::BottomLeft);
 
         if (testFlag(ShowTileObjectOutlines)) {
             QPointF tileOffset;
@@ -492,10 +493,8 @@ void OrthogonalRenderer::drawMapObject(QPainter *painter,
         }
 
         case MapObject::Text: {
-            const auto& textData = object->textData();
-            painter->setFont(textData.font);
-            painter->setPen(textData.color);
-            painter->drawText(rect, textData.text, textData.textOption());
+            painter->setPen(object->textData().color);
+            object->textLayout().draw(painter, rect.topLeft());
             break;
         }
         case MapObject::Point: {
@@ -508,6 +507,124 @@ void OrthogonalRenderer::drawMapObject(QPainter *painter,
     painter->restore();
 }
 
+void OrthogonalRenderer::drawTileObject(CellRenderer &cellRenderer,
+                                        const MapObject *object) const
+{
+    cellRenderer.render(object->cell(), object->position(), object->size(),
+                        CellRenderer::BottomLeft);
+}
+
+bool OrthogonalRenderer::addObjectOutline(ObjectOutlines &outlines,
+                                          const MapObject *object,
+                                          const QTransform &transform) const
+{
+    if (!object->cell().isEmpty())
+        return false;
+
+    QRectF rect(object->bounds());
+
+    // Same workaround as in drawMapObject()
+    MapObject::Shape shape = object->shape();
+    if (shape == MapObject::Ellipse &&
+            ((rect.width() == qreal(0)) ^ (rect.height() == qreal(0)))) {
+        shape = MapObject::Rectangle;
+    }
+
+    QPainterPath path;
+
+    switch (shape) {
+    case MapObject::Rectangle:
+    case MapObject::Ellipse:
+        if (rect.isNull())
+            rect = QRectF(rect.topLeft() - QPointF(10, 10), QSizeF(20, 20));
+
+        if (shape == MapObject::Rectangle)
+            path.addRect(rect);
+        else
+            path.addEllipse(rect);
+
+        path = transform.map(path);
+        outlines.fills.append(path);
+        break;
+
+    case MapObject::Polygon:
+    case MapObject::Polyline: {
+        QPolygonF screenPolygon = pixelToScreenCoords(object->polygon());
+        screenPolygon = transform.map(screenPolygon.translated(rect.topLeft()));
+        if (screenPolygon.isEmpty())
+            return false;
+
+        path.addPolygon(screenPolygon);
+        if (shape == MapObject::Polygon) {
+            path.closeSubpath();
+            outlines.fills.append(path);
+        }
+        outlines.markers.append(screenPolygon.first());
+        break;
+    }
+
+    case MapObject::Text:
+    case MapObject::Point:
+        return false;
+    }
+
+    outlines.lines.addPath(path);
+    return true;
+}
+
+void OrthogonalRenderer::drawObjectOutlines(QPainter *painter,
+                                            const ObjectOutlines &outlines,
+                                            const QColor &color) const
+{
+    if (outlines.isEmpty())
+        return;
+
+    const qreal lineWidth = objectLineWidth();
+    const qreal scale = painterScale();
+    const qreal shadowDist = (lineWidth == 0 ? 1 : lineWidth) / scale;
+    const QPointF shadowOffset = QPointF(shadowDist * 0.5,
+                                         shadowDist * 0.5);
+
+    QPen linePen(color, lineWidth, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
+    linePen.setCosmetic(true);
+    QPen shadowPen(linePen);
+    shadowPen.setColor(Qt::black);
+
+    QPen thickShadowPen(shadowPen);
+    QPen thickLinePen(linePen);
+    thickShadowPen.setWidthF(thickShadowPen.widthF() * 4);
+    thickLinePen.setWidthF(thickLinePen.widthF() * 4);
+
+    QColor brushColor = color;
+    brushColor.setAlpha(50);
+    const QBrush fillBrush(brushColor);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    // Draw the shadows
+    painter->translate(shadowOffset);
+    painter->setBrush(Qt::NoBrush);
+    painter->setPen(shadowPen);
+    painter->drawPath(outlines.lines);
+    painter->setPen(thickShadowPen);
+    painter->drawPoints(outlines.markers);
+    painter->translate(-shadowOffset);
+
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(fillBrush);
+    for (const QPainterPath &fill : outlines.fills)
+        painter->drawPath(fill);
+
+    painter->setBrush(Qt::NoBrush);
+    painter->setPen(linePen);
+    painter->drawPath(outlines.lines);
+    painter->setPen(thickLinePen);
+    painter->drawPoints(outlines.markers);
+
+    painter->restore();
+}
+
 QPointF OrthogonalRenderer::pixelToTileCoords(qreal x, qreal y) const
 {
     return QPointF(x / map()->tileWidth(),
@@ -37,6 +37,12 @@ namespace Tiled {
 
 void Properties::merge(const Properties &other)
 {
+    // Keep sharing the other properties when there is nothing to merge with
+    if (isEmpty()) {
+        *this = other;
+        return;
+    }
+
     // Based on QMap::unite, but using insert instead of insertMulti
     const_iterator it = other.constEnd();
     const const_iterator b = other.constBegin();
@@ -87,6 +93,160 @@ Properties Properties::fromJson(const QJsonArray &json)
     return properties;
 }
 
+static uint hashProperties(const Properties &properties)
+{
+    uint h = 0;
+    for (auto it = properties.begin(), it_end = properties.end(); it != it_end; ++it) {
+        h = qHash(it.key(), h);
+        h = qHash(it.value().toString(), h ^ uint(it.value().userType()));
+    }
+    return h;
+}
+
+/**
+ * Returns a string equal to \a name, sharing its storage with any equal
+ * name passed before.
+ */
+QString PropertiesPool::name(const QString &name)
+{
+    auto it = mNames.constFind(name);
+    if (it == mNames.constEnd())
+        it = mNames.insert(name);
+    return *it;
+}
+
+/**
+ * Returns properties equal to \a properties, sharing their storage with any
+ * equal properties passed before.
+ */
+Properties PropertiesPool::share(const Properties &properties)
+{
+    if (properties.isEmpty())
+        return properties;
+
+    const uint h = hashProperties(properties);
+
+    auto it = mPropertySets.constFind(h);
+    for (; it != mPropertySets.constEnd() && it.key() == h; ++it)
+        if (it.value() == properties)
+            return it.value();
+
+    mPropertySets.insert(h, properties);
+    return properties;
+}
+
+void PropertiesPool::clear()
+{
+    mNames.clear();
+    mPropertySets.clear();
+}
+
+
+// Rough size of a QMap node holding a QString key and a QVariant value
+static const int propertyNodeSize = 3 * sizeof(void*) + sizeof(QString) + sizeof(QVariant);
+
+static qint64 stringSize(const QString &string)
+{
+    return 24 + string.size() * qint64(sizeof(QChar));
+}
+
+PropertiesMemoryReport::PropertiesMemoryReport()
+    : mPropertySetCount(0)
+    , mMemoryUsage(0)
+    , mUnsharedMemoryUsage(0)
+{
+}
+
+void PropertiesMemoryReport::add(const Properties &properties)
+{
+    if (properties.isEmpty())
+        return;
+
+    ++mPropertySetCount;
+
+    qint64 unsharedSize = 0;
+    for (auto it = properties.begin(), it_end = properties.end(); it != it_end; ++it) {
+        unsharedSize += propertyNodeSize + stringSize(it.key());
+        if (it.value().userType() == QMetaType::QString)
+            unsharedSize += stringSize(it.value().toString());
+    }
+    mUnsharedMemoryUsage += unsharedSize;
+
+    // Only count storage not seen before
+    const uint h = hashProperties(properties);
+    auto it = mSharedPropertySets.constFind(h);
+    for (; it != mSharedPropertySets.constEnd() && it.key() == h; ++it)
+        if (it.value().isSharedWith(properties))
+            return;
+
+    mSharedPropertySets.insert(h, properties);
+
+    for (auto it = properties.begin(), it_end = properties.end(); it != it_end; ++it) {
+        mMemoryUsage += propertyNodeSize;
+
+        const QString &key = it.key();
+        if (!mStrings.contains(key.constData())) {
+            mStrings.insert(key.constData());
+            mMemoryUsage += stringSize(key);
+        }
+
+        if (it.value().userType() == QMetaType::QString) {
+            const QString value = it.value().toString();
+            if (!mStrings.contains(value.constData())) {
+                mStrings.insert(value.constData());
+                mMemoryUsage += stringSize(value);
+            }
+        }
+    }
+}
+
+
+/**
+ * Returns the key by which values are compared. Using the exported text
+ * allows the distinct values to be counted in a hash, so that collections
+ * can be disaggregated again without re-aggregating the remaining ones.
+ */
+static QString valueKey(const QVariant &value)
+{
+    return toExportValue(value).toString();
+}
+
+void AggregatedPropertyData::aggregate(const QVariant &value)
+{
+    if (mPresenceCount == 0)
+        mValue = value;
+
+    ValueCount &valueCount = mValueCounts[valueKey(value)];
+    if (valueCount.count == 0)
+        valueCount.value = value;
+
+    ++valueCount.count;
+    ++mPresenceCount;
+}
+
+/**
+ * Undoes a previous call to aggregate() with the same \a value.
+ */
+void AggregatedPropertyData::disaggregate(const QVariant &value)
+{
+    const QString key = valueKey(value);
+    auto it = mValueCounts.find(key);
+    if (it == mValueCounts.end())
+        return;
+
+    --mPresenceCount;
+
+    if (--it.value().count == 0) {
+        mValueCounts.erase(it);
+
+        // Take the value of one of the remaining collections instead
+        if (mValueCounts.isEmpty())
+            mValue = QVariant();
+        else if (key == valueKey(mValue))
+            mValue = mValueCounts.constBegin().value().value;
+    }
+}
+
 void AggregatedProperties::aggregate(const Properties &properties)
 {
     auto it = properties.constEnd();
@@ -104,6 +264,24 @@ void AggregatedProperties::aggregate(const Properties &properties)
     }
 }
 
+/**
+ * Removes the given \a properties, which should have been aggregated before.
+ * Properties no longer present in any collection are removed entirely.
+ */
+void AggregatedProperties::disaggregate(const Properties &properties)
+{
+    for (auto it = properties.constBegin(); it != properties.constEnd(); ++it) {
+        auto pit = find(it.key());
+        if (pit == end())
+            continue;
+
+        AggregatedPropertyData &propertyData = pit.value();
+        propertyData.disaggregate(it.value());
+        if (propertyData.presenceCount() == 0)
+            erase(pit);
+    }
+}
+
 int filePathTypeId()
 {
     return qMetaTypeId<FilePath>();
@@ -30,8 +30,11 @@
 
 #include "tiled_global.h"
 
+#include <QHash>
 #include <QJsonArray>
 #include <QMap>
+#include <QMultiHash>
+#include <QSet>
 #include <QString>
 #include <QUrl>
 #include <QVariant>
@@ -56,41 +59,92 @@ public:
     static Properties fromJson(const QJsonArray &json);
 };
 
+/**
+ * Shares the storage of property names and of identical sets of properties.
+ *
+ * Properties are implicitly shared, but when reading a file each object gets
+ * its own copy. Passing them through a pool makes objects with the same
+ * properties share a single instance, which is detached again only when one
+ * of them is modified.
+ */
+class TILEDSHARED_EXPORT PropertiesPool
+{
+public:
+    QString name(const QString &name);
+    Properties share(const Properties &properties);
+
+    void clear();
+
+private:
+    QSet<QString> mNames;
+    QMultiHash<uint, Properties> mPropertySets;
+};
+
+/**
+ * Estimates the memory used by a number of property sets, taking into
+ * account the sharing of property sets and of their names and values.
+ */
+class TILEDSHARED_EXPORT PropertiesMemoryReport
+{
+public:
+    PropertiesMemoryReport();
+
+    void add(const Properties &properties);
+
+    /** Number of non-empty property sets that were added. */
+    int propertySetCount() const { return mPropertySetCount; }
+
+    /** Number of distinct instances among the added property sets. */
+    int sharedPropertySetCount() const { return mSharedPropertySets.size(); }
+
+    qint64 memoryUsage() const { return mMemoryUsage; }
+    qint64 unsharedMemoryUsage() const { return mUnsharedMemoryUsage; }
+
+private:
+    int mPropertySetCount;
+    qint64 mMemoryUsage;
+    qint64 mUnsharedMemoryUsage;
+    QMultiHash<uint, Properties> mSharedPropertySets;
+    QSet<const void*> mStrings;
+};
+
 class TILEDSHARED_EXPORT AggregatedPropertyData
 {
 public:
     AggregatedPropertyData()
         : mPresenceCount(0)
-        , mValueConsistent(true)
     {}
 
     explicit AggregatedPropertyData(const QVariant &value)
-        : mValue(value)
-        , mPresenceCount(1)
-        , mValueConsistent(true)
-    {}
-
-    void aggregate(const QVariant &value)
+        : mPresenceCount(0)
     {
-        mValueConsistent &= value == mValue;
-        mPresenceCount += 1;
+        aggregate(value);
     }
 
+    void aggregate(const QVariant &value);
+    void disaggregate(const QVariant &value);
+
     const QVariant &value() const { return mValue; }
     int presenceCount() const { return mPresenceCount; }
-    bool valueConsistent() const { return mValueConsistent; }
+    bool valueConsistent() const { return mValueCounts.size() <= 1; }
 
     bool operator==(const AggregatedPropertyData &other) const
     {
         return mValue == other.mValue &&
                 mPresenceCount == other.mPresenceCount &&
-                mValueConsistent == other.mValueConsistent;
+                valueConsistent() == other.valueConsistent();
     }
 
 private:
+    struct ValueCount
+    {
+        QVariant value;
+        int count = 0;
+    };
+
     QVariant mValue;
     int mPresenceCount;
-    bool mValueConsistent;
+    QHash<QString, ValueCount> mValueCounts;   // distinct values by text
 };
 
 /**
@@ -101,6 +155,7 @@ class TILEDSHARED_EXPORT AggregatedProperties : public QMap<QString, AggregatedP
 {
 public:
     void aggregate(const Properties &properties);
+    void disaggregate(const Properties &properties);
 };
 
 
@@ -0,0 +1,106 @@
+/*
+ * regionbuilder.cpp
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "regionbuilder.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace Tiled {
+
+static bool spanLessThan(const QRect &a, const QRect &b)
+{
+    if (a.top() != b.top())
+        return a.top() < b.top();
+    return a.left() < b.left();
+}
+
+static bool sameColumns(const QRect *a, const QRect *b, int count)
+{
+    for (int i = 0; i < count; ++i)
+        if (a[i].left() != b[i].left() || a[i].right() != b[i].right())
+            return false;
+    return true;
+}
+
+/**
+ * Returns the region covered by all added spans.
+ */
+QRegion RegionBuilder::region() const
+{
+    if (mSpans.isEmpty())
+        return QRegion();
+
+    QVector<QRect> spans = mSpans;
+    if (!std::is_sorted(spans.cbegin(), spans.cend(), spanLessThan))
+        std::sort(spans.begin(), spans.end(), spanLessThan);
+
+    QVector<QRect> rects;
+    rects.reserve(spans.size());
+
+    int bandStart = 0;              // first rect of the previous band
+    int bandBottom = INT_MIN;       // bottom row of the previous band
+
+    for (int i = 0; i < spans.size(); ) {
+        const int y = spans.at(i).top();
+        const int rowStart = rects.size();
+
+        // Merge the overlapping and adjacent spans on this row
+        QRect current = spans.at(i);
+        for (++i; i < spans.size() && spans.at(i).top() == y; ++i) {
+            const QRect &span = spans.at(i);
+            if (span.left() <= current.right() + 1) {
+                if (span.right() > current.right())
+                    current.setRight(span.right());
+            } else {
+                rects.append(current);
+                current = span;
+            }
+        }
+        rects.append(current);
+
+        // Extend the previous band when this row covers the same columns
+        const int rowCount = rects.size() - rowStart;
+        if (bandBottom == y - 1 &&
+                rowStart - bandStart == rowCount &&
+                sameColumns(rects.constData() + bandStart, rects.constData() + rowStart, rowCount)) {
+            rects.resize(rowStart);
+            for (int j = bandStart; j < rowStart; ++j)
+                rects[j].setBottom(y);
+        } else {
+            bandStart = rowStart;
+        }
+
+        bandBottom = y;
+    }
+
+    QRegion region;
+    region.setRects(rects.constData(), rects.size());
+    return region;
+}
+
+} // namespace Tiled
@@ -0,0 +1,79 @@
+/*
+ * regionbuilder.h
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QRect>
+#include <QRegion>
+#include <QVector>
+
+namespace Tiled {
+
+/**
+ * Builds a QRegion out of horizontal spans of cells.
+ *
+ * Uniting many small rectangles into a QRegion one at a time is quadratic,
+ * since the region is rebuilt on each union. This class collects the spans
+ * instead and constructs the region in one go, merging overlapping spans and
+ * combining identical consecutive rows into bands, as QRegion expects.
+ */
+class TILEDSHARED_EXPORT RegionBuilder
+{
+public:
+    void addSpan(int left, int right, int y);
+
+    bool isEmpty() const;
+    void clear();
+
+    QRegion region() const;
+
+private:
+    QVector<QRect> mSpans;
+};
+
+/**
+ * Adds the cells from \a left to \a right (inclusive) on row \a y. Spans may
+ * be added in any order and may overlap.
+ */
+inline void RegionBuilder::addSpan(int left, int right, int y)
+{
+    mSpans.append(QRect(left, y, right - left + 1, 1));
+}
+
+inline bool RegionBuilder::isEmpty() const
+{
+    return mSpans.isEmpty();
+}
+
+inline void RegionBuilder::clear()
+{
+    mSpans.clear();
+}
+
+} // namespace Tiled
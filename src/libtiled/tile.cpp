@@ -28,16 +28,53 @@
 
 #include "tile.h"
 
+#include "imagecache.h"
 #include "objectgroup.h"
 #include "tileset.h"
+#include "tilesetmanager.h"
+
+#include "qtcompat_p.h"
+
+#include <QSet>
+#include <QVector>
+
+#include <algorithm>
 
 using namespace Tiled;
 
+namespace {
+
+// Images loaded on demand that have not been used recently are released once
+// they take more memory than this
+const qint64 ON_DEMAND_IMAGE_BUDGET = 256 * 1024 * 1024;
+
+struct OnDemandImages
+{
+    OnDemandImages() : bytes(0) {}
+
+    QSet<const Tile*> tiles;
+    qint64 bytes;
+};
+
+Q_GLOBAL_STATIC(OnDemandImages, onDemandImages)
+
+qint64 imageBytes(const QPixmap &pixmap)
+{
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+} // anonymous namespace
+
+unsigned Tile::sImageUseEpoch;
+
 Tile::Tile(int id, Tileset *tileset):
     Object(TileType),
     mId(id),
     mTileset(tileset),
+    mImageSize(0, 0),
     mImageStatus(LoadingReady),
+    mImageLoadedOnDemand(false),
+    mImageLastUsed(0),
     mTerrain(-1),
     mProbability(1.0),
     mObjectGroup(nullptr),
@@ -50,7 +87,10 @@ Tile::Tile(const QPixmap &image, int id, Tileset *tileset):
     mId(id),
     mTileset(tileset),
     mImage(image),
+    mImageSize(image.size()),
     mImageStatus(image.isNull() ? LoadingError : LoadingReady),
+    mImageLoadedOnDemand(false),
+    mImageLastUsed(0),
     mTerrain(-1),
     mProbability(1.0),
     mObjectGroup(nullptr),
@@ -60,9 +100,125 @@ Tile::Tile(const QPixmap &image, int id, Tileset *tileset):
 
 Tile::~Tile()
 {
+    if (mImageLoadedOnDemand)
+        forgetOnDemandImage();
+    else if (mImageStatus == LoadingPending)
+        ImageCache::cancelPreload(mImageSource.toLocalFile());
+
     delete mObjectGroup;
 }
 
+/**
+ * Sets the image of this tile to be loaded from the local file
+ * \a imageSource when it is first needed. Until then, the tile has the
+ * given \a imageSize.
+ */
+void Tile::setPendingImage(const QUrl &imageSource, QSize imageSize)
+{
+    if (mImageLoadedOnDemand)
+        forgetOnDemandImage();
+    mImage = QPixmap();
+    mImageSize = imageSize;
+    mImageSource = imageSource;
+    mImageStatus = LoadingPending;
+}
+
+/**
+ * Starts decoding a pending image on the thread pool, so that it is ready
+ * by the time it is needed. Does nothing when the image is already loaded.
+ */
+void Tile::preloadImage() const
+{
+    if (mImageStatus == LoadingPending)
+        ImageCache::preloadImage(mImageSource.toLocalFile());
+}
+
+/**
+ * Returns whether image() can return without decoding the image. Otherwise,
+ * the image starts decoding in the background and the TilesetManager emits
+ * repaintTileset() once it is available.
+ */
+bool Tile::requestImage() const
+{
+    if (mImageStatus != LoadingPending)
+        return true;
+
+    const QString fileName = mImageSource.toLocalFile();
+    if (ImageCache::isImageAvailable(fileName))
+        return true;
+
+    TilesetManager::instance()->repaintTilesetWhenLoaded(mTileset, fileName);
+    ImageCache::preloadImage(fileName);
+    return false;
+}
+
+void Tile::loadPendingImage() const
+{
+    mImage = ImageCache::loadUncachedPixmap(mImageSource.toLocalFile());
+    mImageStatus = mImage.isNull() ? LoadingError : LoadingReady;
+
+    if (mImageStatus == LoadingReady)
+        trackOnDemandImage();
+}
+
+/**
+ * Keeps track of the memory used by this tile's image, so that it can be
+ * released again when the images loaded on demand take too much memory.
+ */
+void Tile::trackOnDemandImage() const
+{
+    OnDemandImages *images = onDemandImages();
+
+    mImageLoadedOnDemand = true;
+    mImageLastUsed = sImageUseEpoch;
+    images->tiles.insert(this);
+    images->bytes += imageBytes(mImage);
+
+    if (images->bytes > ON_DEMAND_IMAGE_BUDGET)
+        releaseUnusedImages();
+}
+
+void Tile::forgetOnDemandImage() const
+{
+    mImageLoadedOnDemand = false;
+
+    // May be called after the global has been destroyed on exit
+    if (OnDemandImages *images = onDemandImages()) {
+        images->tiles.remove(this);
+        images->bytes -= imageBytes(mImage);
+    }
+}
+
+/**
+ * Releases the images loaded on demand that were not used since this was
+ * last called, least recently used first, until they fit in three quarters
+ * of the budget. Released images become pending again.
+ */
+void Tile::releaseUnusedImages()
+{
+    OnDemandImages *images = onDemandImages();
+
+    QVector<const Tile*> unused;
+    for (const Tile *tile : qAsConst(images->tiles))
+        if (tile->mImageLastUsed != sImageUseEpoch)
+            unused.append(tile);
+
+    std::sort(unused.begin(), unused.end(), [] (const Tile *a, const Tile *b) {
+        return a->mImageLastUsed < b->mImageLastUsed;
+    });
+
+    for (const Tile *tile : qAsConst(unused)) {
+        if (images->bytes <= ON_DEMAND_IMAGE_BUDGET / 4 * 3)
+            break;
+
+        tile->forgetOnDemandImage();
+        tile->mImage = QPixmap();
+        tile->mImageStatus = LoadingPending;
+    }
+
+    ++sImageUseEpoch;
+}
+
 /**
  * Returns the tileset that this tile is part of as a shared pointer.
  */
@@ -204,7 +360,11 @@ Tile *Tile::clone(Tileset *tileset) const
     Tile *c = new Tile(mImage, mId, tileset);
     c->setProperties(properties());
 
+    c->mImageSize = mImageSize;
     c->mImageSource = mImageSource;
+    c->mImageStatus = mImageStatus;
+    if (mImageLoadedOnDemand)
+        c->trackOnDemandImage();
     c->mTerrain = mTerrain;
     c->mProbability = mProbability;
 
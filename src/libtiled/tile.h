@@ -105,6 +105,9 @@ public:
 
     const QPixmap &image() const;
     void setImage(const QPixmap &image);
+    void setPendingImage(const QUrl &imageSource, QSize imageSize);
+    void preloadImage() const;
+    bool requestImage() const;
 
     const Tile *currentFrameTile() const;
 
@@ -148,11 +151,19 @@ public:
     Tile *clone(Tileset *tileset) const;
 
 private:
+    void loadPendingImage() const;
+    void trackOnDemandImage() const;
+    void forgetOnDemandImage() const;
+    static void releaseUnusedImages();
+
     int mId;
     Tileset *mTileset;
-    QPixmap mImage;
+    mutable QPixmap mImage;             // loaded on demand while pending
+    QSize mImageSize;
     QUrl mImageSource;
-    LoadingStatus mImageStatus;
+    mutable LoadingStatus mImageStatus;
+    mutable bool mImageLoadedOnDemand;  // may be released when unused
+    mutable unsigned mImageLastUsed;
     QString mType;
     unsigned mTerrain;
     qreal mProbability;
@@ -162,6 +173,8 @@ private:
     int mCurrentFrameIndex;
     int mUnusedTime;
 
+    static unsigned sImageUseEpoch;
+
     friend class Tileset; // To allow changing the tile id
 };
 
@@ -182,10 +195,14 @@ inline Tileset *Tile::tileset() const
 }
 
 /**
- * Returns the image of this tile.
+ * Returns the image of this tile. A pending image is loaded when it is first
+ * requested, and may be released again when it has not been used for a while.
  */
 inline const QPixmap &Tile::image() const
 {
+    if (mImageStatus == LoadingPending)
+        loadPendingImage();
+    mImageLastUsed = sImageUseEpoch;
     return mImage;
 }
 
@@ -194,7 +211,10 @@ inline const QPixmap &Tile::image() const
  */
 inline void Tile::setImage(const QPixmap &image)
 {
+    if (mImageLoadedOnDemand)
+        forgetOnDemandImage();
     mImage = image;
+    mImageSize = image.size();
     mImageStatus = image.isNull() ? LoadingError : LoadingReady;
 }
 
@@ -214,11 +234,12 @@ inline void Tile::setImageSource(const QUrl &imageSource)
 }
 
 /**
- * Returns the width of this tile.
+ * Returns the width of this tile. Does not require a pending image to be
+ * loaded.
  */
 inline int Tile::width() const
 {
-    return mImage.width();
+    return mImageSize.width();
 }
 
 /**
@@ -226,7 +247,7 @@ inline int Tile::width() const
  */
 inline int Tile::height() const
 {
-    return mImage.height();
+    return mImageSize.height();
 }
 
 /**
@@ -234,7 +255,7 @@ inline int Tile::height() const
  */
 inline QSize Tile::size() const
 {
-    return mImage.size();
+    return mImageSize;
 }
 
 /**
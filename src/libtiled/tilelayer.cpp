@@ -31,32 +31,40 @@
 
 #include "tile.h"
 #include "hex.h"
+#include "regionbuilder.h"
 
 #include <algorithm>
 #include <memory>
 
 using namespace Tiled;
 
+/**
+ * Adds the spans of cells on row \a y of this chunk for which the given
+ * \a condition returns true to \a builder, offset by \a origin.
+ */
+void Chunk::addRowSpans(RegionBuilder &builder,
+                        int y,
+                        const std::function<bool (const Cell &)> &condition,
+                        QPoint origin) const
+{
+    for (int x = 0; x < CHUNK_SIZE; ++x) {
+        if (condition(cellAt(x, y))) {
+            const int rangeStart = x;
+            while (x + 1 < CHUNK_SIZE && condition(cellAt(x + 1, y)))
+                ++x;
+            builder.addSpan(origin.x() + rangeStart, origin.x() + x, origin.y() + y);
+        }
+    }
+}
+
 QRegion Chunk::region(std::function<bool (const Cell &)> condition) const
 {
-    QRegion region;
+    RegionBuilder builder;
 
-    for (int y = 0; y < CHUNK_SIZE; ++y) {
-        for (int x = 0; x < CHUNK_SIZE; ++x) {
-            if (condition(cellAt(x, y))) {
-                const int rangeStart = x;
-                for (++x; x <= CHUNK_SIZE; ++x) {
-                    if (x == CHUNK_SIZE || !condition(cellAt(x, y))) {
-                        const int rangeEnd = x;
-                        region += QRect(rangeStart, y, rangeEnd - rangeStart, 1);
-                        break;
-                    }
-                }
-            }
-        }
-    }
+    for (int y = 0; y < CHUNK_SIZE; ++y)
+        addRowSpans(builder, y, condition, QPoint());
 
-    return region;
+    return builder.region();
 }
 
 void Chunk::setCell(int x, int y, const Cell &cell)
@@ -97,9 +105,12 @@ void Chunk::removeReferencesToTileset(Tileset *tileset)
 
 void Chunk::replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset)
 {
-    for (Cell &cell : mGrid) {
-        if (cell.tileset() == oldTileset)
+    // Avoid detaching the grid when it doesn't refer to the old tileset
+    for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
+        if (mGrid.at(i).tileset() == oldTileset) {
+            Cell &cell = mGrid[i];
             cell.setTile(newTileset, cell.tileId());
+        }
     }
 }
 
@@ -107,7 +118,7 @@ TileLayer::TileLayer(const QString &name, int x, int y, int width, int height)
     : Layer(TileLayerType, name, x, y)
     , mWidth(width)
     , mHeight(height)
-    , mUsedTilesetsDirty(false)
+    , mRegionDirty(false)
 {
     Q_ASSERT(width >= 0);
     Q_ASSERT(height >= 0);
@@ -163,16 +174,57 @@ QMargins TileLayer::drawMargins() const
  */
 QRegion TileLayer::region(std::function<bool (const Cell &)> condition) const
 {
-    QRegion region;
+    // Visit the chunks by row and column, so that the spans are found in the
+    // order expected by QRegion
+    QVector<QPair<QPoint, const Chunk*>> chunks;
+    chunks.reserve(mChunks.size());
+    for (auto it = mChunks.cbegin(); it != mChunks.cend(); ++it)
+        chunks.append(qMakePair(it.key(), &it.value()));
 
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
-        region += it.value().region(condition).translated(it.key().x() * CHUNK_SIZE + mX,
-                                                          it.key().y() * CHUNK_SIZE + mY);
+    std::sort(chunks.begin(), chunks.end(), [] (const QPair<QPoint, const Chunk*> &a,
+                                                 const QPair<QPoint, const Chunk*> &b) {
+        if (a.first.y() != b.first.y())
+            return a.first.y() < b.first.y();
+        return a.first.x() < b.first.x();
+    });
+
+    RegionBuilder builder;
+
+    for (int rowStart = 0; rowStart < chunks.size(); ) {
+        const int chunkY = chunks.at(rowStart).first.y();
+
+        int rowEnd = rowStart + 1;
+        while (rowEnd < chunks.size() && chunks.at(rowEnd).first.y() == chunkY)
+            ++rowEnd;
+
+        for (int y = 0; y < CHUNK_SIZE; ++y) {
+            for (int i = rowStart; i < rowEnd; ++i) {
+                const QPoint origin(chunks.at(i).first.x() * CHUNK_SIZE + mX,
+                                    chunkY * CHUNK_SIZE + mY);
+                chunks.at(i).second->addRowSpans(builder, y, condition, origin);
+            }
+        }
+
+        rowStart = rowEnd;
     }
 
-    return region;
+    return builder.region();
+}
+
+/**
+ * Calculates the region occupied by the tiles of this layer. Similar to
+ * Layer::bounds(), but leaves out the regions without tiles.
+ *
+ * The region is cached until the layer is changed in a way that affects it.
+ */
+QRegion TileLayer::region() const
+{
+    if (mRegionDirty) {
+        mRegion = region([] (const Cell &cell) { return !cell.isEmpty(); }).translated(-position());
+        mRegionDirty = false;
+    }
+
+    return mRegion.translated(position());
 }
 
 /**
@@ -192,30 +244,152 @@ void Tiled::TileLayer::setCell(int x, int y, const Cell &cell)
     }
 
     Chunk &_chunk = chunk(x, y);
+    const Cell &oldCell = _chunk.cellAt(x & CHUNK_MASK, y & CHUNK_MASK);
+
+    if (oldCell.isEmpty() != cell.isEmpty())
+        mRegionDirty = true;
+
+    Tileset *oldTileset = oldCell.tileset();
+    Tileset *newTileset = cell.tileset();
+    if (oldTileset != newTileset) {
+        if (oldTileset)
+            removeTilesetReference(oldTileset);
+        if (newTileset)
+            addTilesetReference(newTileset);
+    }
+
+    _chunk.setCell(x & CHUNK_MASK, y & CHUNK_MASK, cell);
+}
+
+void TileLayer::addTilesetReference(Tileset *tileset)
+{
+    int &count = mTilesetReferenceCounts[tileset];
+    if (count++ == 0)
+        mUsedTilesets.insert(tileset->sharedPointer());
+}
+
+void TileLayer::removeTilesetReference(Tileset *tileset)
+{
+    auto it = mTilesetReferenceCounts.find(tileset);
+    Q_ASSERT(it != mTilesetReferenceCounts.end());
+
+    if (--it.value() == 0) {
+        mTilesetReferenceCounts.erase(it);
+        mUsedTilesets.remove(tileset->sharedPointer());
+    }
+}
+
+/**
+ * Takes over the cells of \a other, which is expected to be a temporary
+ * layer used to compute a changed version of this layer.
+ */
+void TileLayer::takeCells(TileLayer &other)
+{
+    mChunks.swap(other.mChunks);
+    mBounds = other.mBounds;
+    mUsedTilesets.swap(other.mUsedTilesets);
+    mTilesetReferenceCounts.swap(other.mTilesetReferenceCounts);
+    mRegionDirty = true;
+}
 
-    if (!mUsedTilesetsDirty) {
-        Tileset *oldTileset = _chunk.cellAt(x & CHUNK_MASK, y & CHUNK_MASK).tileset();
-        Tileset *newTileset = cell.tileset();
-        if (oldTileset != newTileset) {
-            if (oldTileset)
-                mUsedTilesetsDirty = true;
-            else if (newTileset)
-                mUsedTilesets.insert(newTileset->sharedPointer());
+static int chunkCoordinate(int coordinate)
+{
+    return coordinate < 0 ? (coordinate + 1) / CHUNK_SIZE - 1 : coordinate / CHUNK_SIZE;
+}
+
+static bool isChunkAligned(const QPoint &offset)
+{
+    return (offset.x() & CHUNK_MASK) == 0 && (offset.y() & CHUNK_MASK) == 0;
+}
+
+/**
+ * Replaces the chunk at the given chunk coordinates with \a chunk. Since
+ * chunks are implicitly shared, their cells are only copied once either of
+ * the layers modifies them.
+ */
+void TileLayer::shareChunk(const QPoint &chunkCoordinates, const Chunk &chunk)
+{
+    auto it = mChunks.find(chunkCoordinates);
+    if (it == mChunks.end()) {
+        it = mChunks.insert(chunkCoordinates, chunk);
+        mBounds = mBounds.united(QRect(chunkCoordinates * CHUNK_SIZE,
+                                       QSize(CHUNK_SIZE, CHUNK_SIZE)));
+    } else {
+        for (const Cell &cell : qAsConst(it.value()))
+            if (Tileset *tileset = cell.tileset())
+                removeTilesetReference(tileset);
+        it.value() = chunk;
+    }
+
+    for (const Cell &cell : chunk)
+        if (Tileset *tileset = cell.tileset())
+            addTilesetReference(tileset);
+
+    mRegionDirty = true;
+}
+
+/**
+ * Shares the chunks of \a source that are completely within \a area with
+ * this layer, placing them at \a offset. This is only possible when
+ * \a offset is aligned to the chunk grid.
+ *
+ * Returns the part of \a area that was not shared and still needs to be
+ * copied cell by cell.
+ */
+QRegion TileLayer::shareChunks(const TileLayer *source,
+                               const QRegion &area,
+                               const QPoint &offset)
+{
+    if (!isChunkAligned(offset) || area.isEmpty())
+        return area;
+
+    const QRect bounds = area.boundingRect();
+    const bool isRect = area.rectCount() == 1;
+    const QPoint chunkOffset = offset / CHUNK_SIZE;
+
+    QRegion shared;
+
+    auto share = [&] (const QPoint &chunkCoordinates, const Chunk &chunk) {
+        const QRect chunkRect(chunkCoordinates * CHUNK_SIZE, QSize(CHUNK_SIZE, CHUNK_SIZE));
+        if (isRect ? bounds.contains(chunkRect) : area.intersected(chunkRect) == QRegion(chunkRect)) {
+            shareChunk(chunkCoordinates + chunkOffset, chunk);
+            shared += chunkRect;
         }
+    };
+
+    // Either look up the chunks within the area or go through all chunks of
+    // the source layer, whichever is less work
+    const QRect chunkBounds(QPoint(chunkCoordinate(bounds.left()), chunkCoordinate(bounds.top())),
+                            QPoint(chunkCoordinate(bounds.right()), chunkCoordinate(bounds.bottom())));
+
+    if (qint64(chunkBounds.width()) * chunkBounds.height() < source->mChunks.size()) {
+        for (int y = chunkBounds.top(); y <= chunkBounds.bottom(); ++y) {
+            for (int x = chunkBounds.left(); x <= chunkBounds.right(); ++x) {
+                auto it = source->mChunks.find(QPoint(x, y));
+                if (it != source->mChunks.end())
+                    share(it.key(), it.value());
+            }
+        }
+    } else {
+        for (auto it = source->mChunks.cbegin(); it != source->mChunks.cend(); ++it)
+            if (chunkBounds.contains(it.key()))
+                share(it.key(), it.value());
     }
 
-    _chunk.setCell(x & CHUNK_MASK, y & CHUNK_MASK, cell);
+    return shared.isEmpty() ? area : area.subtracted(shared);
 }
 
 TileLayer *TileLayer::copy(const QRegion &region) const
 {
     const QRect regionBounds = region.boundingRect();
-    const QRegion regionWithContents = region.intersected(mBounds);
+    QRegion regionWithContents = region.intersected(mBounds);
 
     TileLayer *copied = new TileLayer(QString(),
                                       0, 0,
                                       regionBounds.width(), regionBounds.height());
 
+    regionWithContents = copied->shareChunks(this, regionWithContents, -regionBounds.topLeft());
+
 #if QT_VERSION < 0x050800
     const auto rects = regionWithContents.rects();
     for (const QRect &rect : rects) {
@@ -248,7 +422,7 @@ void TileLayer::merge(const QPoint &pos, const TileLayer *layer)
     }
 }
 
-void TileLayer::setCells(int x, int y, TileLayer *layer,
+void TileLayer::setCells(int x, int y, const TileLayer *layer,
                          const QRegion &mask)
 {
     QRegion area = QRect(x, y, layer->width(), layer->height());
@@ -256,6 +430,8 @@ void TileLayer::setCells(int x, int y, TileLayer *layer,
     if (!mask.isEmpty())
         area &= mask;
 
+    area = shareChunks(layer, area.translated(-x, -y), QPoint(x, y)).translated(x, y);
+
 #if QT_VERSION < 0x050800
     const auto rects = area.rects();
     for (const QRect &rect : rects)
@@ -336,8 +512,7 @@ void TileLayer::flip(FlipDirection direction)
         }
     }
 
-    mChunks = newLayer->mChunks;
-    mBounds = newLayer->mBounds;
+    takeCells(*newLayer);
 }
 
 void TileLayer::flipHexagonal(FlipDirection direction)
@@ -386,8 +561,7 @@ void TileLayer::flipHexagonal(FlipDirection direction)
         }
     }
 
-    mChunks = newLayer->mChunks;
-    mBounds = newLayer->mBounds;
+    takeCells(*newLayer);
 }
 
 void TileLayer::rotate(RotateDirection direction)
@@ -436,8 +610,7 @@ void TileLayer::rotate(RotateDirection direction)
 
     mWidth = newWidth;
     mHeight = newHeight;
-    mChunks = newLayer->mChunks;
-    mBounds = newLayer->mBounds;
+    takeCells(*newLayer);
 }
 
 void TileLayer::rotateHexagonal(RotateDirection direction, Map *map)
@@ -525,8 +698,7 @@ void TileLayer::rotateHexagonal(RotateDirection direction, Map *map)
 
     mWidth = newWidth;
     mHeight = newHeight;
-    mChunks = newLayer->mChunks;
-    mBounds = newLayer->mBounds;
+    takeCells(*newLayer);
 
     QRect filledRect = region().boundingRect();
 
@@ -542,21 +714,12 @@ void TileLayer::rotateHexagonal(RotateDirection direction, Map *map)
 }
 
 
+/**
+ * Returns the tilesets referenced by the cells of this layer. The set is
+ * kept up to date by counting the references to each tileset.
+ */
 QSet<SharedTileset> TileLayer::usedTilesets() const
 {
-    if (mUsedTilesetsDirty) {
-        QSet<SharedTileset> tilesets;
-
-        for (const Chunk &chunk : mChunks) {
-            for (const Cell &cell : chunk)
-                if (const Tile *tile = cell.tile())
-                    tilesets.insert(tile->sharedTileset());
-        }
-
-        mUsedTilesets.swap(tilesets);
-        mUsedTilesetsDirty = false;
-    }
-
     return mUsedTilesets;
 }
 
@@ -572,25 +735,37 @@ bool TileLayer::hasCell(std::function<bool (const Cell &)> condition) const
 
 bool TileLayer::referencesTileset(const Tileset *tileset) const
 {
-    return usedTilesets().contains(tileset->sharedPointer());
+    return mTilesetReferenceCounts.contains(tileset);
 }
 
 void TileLayer::removeReferencesToTileset(Tileset *tileset)
 {
+    if (!mTilesetReferenceCounts.remove(tileset))
+        return;
+
     for (Chunk &chunk : mChunks)
         chunk.removeReferencesToTileset(tileset);
 
+    mRegionDirty = true;
     mUsedTilesets.remove(tileset->sharedPointer());
 }
 
 void TileLayer::replaceReferencesToTileset(Tileset *oldTileset,
                                            Tileset *newTileset)
 {
+    const int count = mTilesetReferenceCounts.take(oldTileset);
+    if (count == 0)
+        return;
+
     for (Chunk &chunk : mChunks)
         chunk.replaceReferencesToTileset(oldTileset, newTileset);
 
-    if (mUsedTilesets.remove(oldTileset->sharedPointer()))
+    mUsedTilesets.remove(oldTileset->sharedPointer());
+
+    int &newCount = mTilesetReferenceCounts[newTileset];
+    if (newCount == 0)
         mUsedTilesets.insert(newTileset->sharedPointer());
+    newCount += count;
 }
 
 void TileLayer::resize(const QSize &size, const QPoint &offset)
@@ -601,13 +776,20 @@ void TileLayer::resize(const QSize &size, const QPoint &offset)
     const std::unique_ptr<TileLayer> newLayer(new TileLayer(QString(), 0, 0, size.width(), size.height()));
 
     // Copy over the preserved part
-    QRect area = mBounds.translated(offset).intersected(newLayer->rect());
-    for (int y = area.top(); y <= area.bottom(); ++y)
-        for (int x = area.left(); x <= area.right(); ++x)
-            newLayer->setCell(x, y, cellAt(x - offset.x(), y - offset.y()));
+    const QRect area = mBounds.translated(offset).intersected(newLayer->rect());
+    const QRegion remaining = newLayer->shareChunks(this, area.translated(-offset), offset);
+
+#if QT_VERSION < 0x050800
+    const auto rects = remaining.rects();
+    for (const QRect &rect : rects)
+#else
+    for (const QRect &rect : remaining)
+#endif
+        for (int y = rect.top(); y <= rect.bottom(); ++y)
+            for (int x = rect.left(); x <= rect.right(); ++x)
+                newLayer->setCell(x + offset.x(), y + offset.y(), cellAt(x, y));
 
-    mChunks = newLayer->mChunks;
-    mBounds = newLayer->mBounds;
+    takeCells(*newLayer);
     setSize(size);
 }
 
@@ -649,14 +831,22 @@ void TileLayer::offsetTiles(const QPoint &offset,
         }
     }
 
-    mChunks = newLayer->mChunks;
-    mBounds = newLayer->mBounds;
+    takeCells(*newLayer);
 }
 
 void TileLayer::offsetTiles(const QPoint &offset)
 {
     const std::unique_ptr<TileLayer> newLayer(new TileLayer(QString(), 0, 0, 0, 0));
 
+    // Move whole chunks when possible
+    if (isChunkAligned(offset)) {
+        for (auto it = mChunks.cbegin(); it != mChunks.cend(); ++it)
+            newLayer->shareChunk(it.key() + offset / CHUNK_SIZE, it.value());
+
+        takeCells(*newLayer);
+        return;
+    }
+
     // Process only the allocated chunks
     QHashIterator<QPoint, Chunk> it(mChunks);
     while (it.hasNext()) {
@@ -677,8 +867,7 @@ void TileLayer::offsetTiles(const QPoint &offset)
         }
     }
 
-    mChunks = newLayer->mChunks;
-    mBounds = newLayer->mBounds;
+    takeCells(*newLayer);
 }
 
 bool TileLayer::canMergeWith(Layer *other) const
@@ -786,6 +975,8 @@ TileLayer *TileLayer::initializeClone(TileLayer *clone) const
     clone->mChunks = mChunks;
     clone->mBounds = mBounds;
     clone->mUsedTilesets = mUsedTilesets;
-    clone->mUsedTilesetsDirty = mUsedTilesetsDirty;
+    clone->mTilesetReferenceCounts = mTilesetReferenceCounts;
+    clone->mRegion = mRegion;
+    clone->mRegionDirty = mRegionDirty;
     return clone;
 }
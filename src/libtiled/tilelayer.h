@@ -54,6 +54,7 @@ inline uint qHash(const QPoint &key, uint seed = 0) Q_DECL_NOTHROW
 
 namespace Tiled {
 
+class RegionBuilder;
 class Tile;
 
 /**
@@ -151,6 +152,10 @@ inline bool Cell::refersTile(const Tile *tile) const
 
 /**
  * A Chunk is a grid of cells of size CHUNK_SIZExCHUNK_SIZE.
+ *
+ * Chunks are implicitly shared, so copying a chunk is cheap and its cells are
+ * only copied when one of the copies is modified. Prefer the const accessors
+ * to avoid needlessly detaching a shared chunk.
  */
 class TILEDSHARED_EXPORT Chunk
 {
@@ -160,6 +165,10 @@ public:
     {}
 
     QRegion region(std::function<bool (const Cell &)> condition) const;
+    void addRowSpans(RegionBuilder &builder,
+                     int y,
+                     const std::function<bool (const Cell &)> &condition,
+                     QPoint origin) const;
 
     const Cell &cellAt(int x, int y) const;
     const Cell &cellAt(const QPoint &point) const;
@@ -354,6 +363,7 @@ public:
     Chunk &chunk(int x, int y);
 
     const Chunk *findChunk(int x, int y) const;
+    int chunkCount() const { return mChunks.size(); }
 
     QRegion region(std::function<bool (const Cell &)> condition) const;
     QRegion region() const;
@@ -391,7 +401,7 @@ public:
      * When a \a mask is given, only cells that fall within this mask are set.
      * The mask is applied in local coordinates.
      */
-    void setCells(int x, int y, TileLayer *tileLayer,
+    void setCells(int x, int y, const TileLayer *tileLayer,
                   const QRegion &mask = QRegion());
 
     void setTiles(const QRegion &area, Tile *tile);
@@ -504,13 +514,21 @@ protected:
     TileLayer *initializeClone(TileLayer *clone) const;
 
 private:
+    void addTilesetReference(Tileset *tileset);
+    void removeTilesetReference(Tileset *tileset);
+    void takeCells(TileLayer &other);
+    void shareChunk(const QPoint &chunkCoordinates, const Chunk &chunk);
+    QRegion shareChunks(const TileLayer *source, const QRegion &area, const QPoint &offset);
+
     int mWidth;
     int mHeight;
     Cell mEmptyCell;
     QHash<QPoint, Chunk> mChunks;
     QRect mBounds;
-    mutable QSet<SharedTileset> mUsedTilesets;
-    mutable bool mUsedTilesetsDirty;
+    QSet<SharedTileset> mUsedTilesets;
+    QHash<const Tileset*, int> mTilesetReferenceCounts;
+    mutable QRegion mRegion;        // cached region(), relative to the layer position
+    mutable bool mRegionDirty;
 };
 
 inline QPoint TileLayer::iterator::key() const
@@ -589,14 +607,6 @@ inline const Chunk* TileLayer::findChunk(int x, int y) const
     return it != mChunks.end() ? &it.value() : nullptr;
 }
 
-/**
- * Calculates the region occupied by the tiles of this layer. Similar to
- * Layer::bounds(), but leaves out the regions without tiles.
- */
-inline QRegion TileLayer::region() const
-{
-    return region([] (const Cell &cell) { return !cell.isEmpty(); });
-}
 
 /**
  * Returns a read-only reference to the cell at the given coordinates. The
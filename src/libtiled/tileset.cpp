@@ -131,6 +131,7 @@ Tile *Tileset::findOrCreateTile(int id)
         return tile;
 
     mNextTileId = std::max(mNextTileId, id + 1);
+    mTerrainDistancesDirty = true;
     return mTiles[id] = new Tile(id, this);
 }
 
@@ -229,6 +230,7 @@ bool Tileset::loadFromImage(const QImage &image, const QUrl &source)
             else
                 mTiles.insert(tileNum, new Tile(tilePixmap, tileNum, this));
 
+            mTerrainDistancesDirty = true;
             ++tileNum;
         }
     }
@@ -307,6 +309,8 @@ bool Tileset::loadImage()
             mTiles.insert(tileNum, new Tile(tiles.at(tileNum), tileNum, this));
     }
 
+    mTerrainDistancesDirty = true;
+
     QPixmap blank;
 
     // Blank out any remaining tiles to avoid confusion (todo: could be more clear)
@@ -546,7 +550,23 @@ int Tileset::maximumTerrainDistance() const
 }
 
 /**
- * Calculates the transition distance matrix for all terrain types.
+ * Returns the tiles of this tileset grouped by their terrain information.
+ *
+ * Since tilesets tend to use only a few distinct terrain combinations, this
+ * allows searching for a matching terrain tile without looking at every
+ * tile. The index is rebuilt along with the terrain distances.
+ */
+const QHash<unsigned, QVector<Tile*>> &Tileset::tilesByTerrain() const
+{
+    if (mTerrainDistancesDirty)
+        const_cast<Tileset*>(this)->recalculateTerrainDistances();
+
+    return mTilesByTerrain;
+}
+
+/**
+ * Calculates the transition distance matrix for all terrain types and
+ * rebuilds the index of tiles by terrain.
  */
 void Tileset::recalculateTerrainDistances()
 {
@@ -558,12 +578,18 @@ void Tileset::recalculateTerrainDistances()
     // Terrains that have no transition path have a distance of -1
     int maximumDistance = 1;
 
+    mTilesByTerrain.clear();
+    for (Tile *tile : qAsConst(mTiles))
+        mTilesByTerrain[tile->terrain()].append(tile);
+
     for (int i = 0; i < terrainCount(); ++i) {
         Terrain *type = terrain(i);
         QVector<int> distance(terrainCount() + 1, -1);
 
-        // Check all tiles for transitions to other terrain types
-        for (const Tile *tile : mTiles) {
+        // Check all terrain combinations for transitions to other terrain
+        // types (tiles sharing the same combination add nothing new)
+        for (const QVector<Tile*> &tiles : qAsConst(mTilesByTerrain)) {
+            const Tile *tile = tiles.first();
             if (!hasByteEqualTo(tile->terrain(), i))
                 continue;
 
@@ -675,6 +701,7 @@ Tile *Tileset::addTile(const QPixmap &image, const QUrl &source)
     newTile->setImageSource(source);
 
     mTiles.insert(newTile->id(), newTile);
+    mTerrainDistancesDirty = true;
     if (mTileHeight < image.height())
         mTileHeight = image.height();
     if (mTileWidth < image.width())
@@ -694,6 +721,7 @@ void Tileset::addTiles(const QList<Tile *> &tiles)
         mTiles.insert(tile->id(), tile);
     }
 
+    mTerrainDistancesDirty = true;
     updateTileSize();
 }
 
@@ -709,6 +737,7 @@ void Tileset::removeTiles(const QList<Tile *> &tiles)
         mTiles.remove(tile->id());
     }
 
+    mTerrainDistancesDirty = true;
     updateTileSize();
 }
 
@@ -718,6 +747,7 @@ void Tileset::removeTiles(const QList<Tile *> &tiles)
 void Tileset::deleteTile(int id)
 {
     delete mTiles.take(id);
+    mTerrainDistancesDirty = true;
 }
 
 /**
@@ -734,12 +764,45 @@ void Tileset::setTileImage(Tile *tile,
     Q_ASSERT(isCollection());
     Q_ASSERT(mTiles.value(tile->id()) == tile);
 
-    const QSize previousImageSize = tile->image().size();
-    const QSize newImageSize = image.size();
+    const QSize previousImageSize = tile->size();
 
     tile->setImage(image);
     tile->setImageSource(source);
 
+    tileImageSizeChanged(previousImageSize, image.size());
+}
+
+/**
+ * Sets the image of the given \a tile to be loaded from the local file
+ * \a source only once it is needed, like when it is first drawn.
+ *
+ * Only the header of the image is read to determine its size, which keeps
+ * opening large image collection tilesets fast. Returns false when the size
+ * could not be determined that way, in which case the image should be
+ * loaded using setTileImage instead.
+ */
+bool Tileset::setPendingTileImage(Tile *tile, const QUrl &source)
+{
+    Q_ASSERT(isCollection());
+    Q_ASSERT(mTiles.value(tile->id()) == tile);
+
+    if (!source.isLocalFile())
+        return false;
+
+    const QSize imageSize = ImageCache::imageSize(source.toLocalFile());
+    if (imageSize.isEmpty())
+        return false;
+
+    const QSize previousImageSize = tile->size();
+
+    tile->setPendingImage(source, imageSize);
+
+    tileImageSizeChanged(previousImageSize, imageSize);
+    return true;
+}
+
+void Tileset::tileImageSizeChanged(QSize previousImageSize, QSize newImageSize)
+{
     if (previousImageSize != newImageSize) {
         // Update our max. tile size
         if (previousImageSize.height() == mTileHeight ||
@@ -775,6 +838,7 @@ void Tileset::swap(Tileset &other)
     std::swap(mExpectedColumnCount, other.mExpectedColumnCount);
     std::swap(mExpectedRowCount, other.mExpectedRowCount);
     std::swap(mTiles, other.mTiles);
+    std::swap(mTilesByTerrain, other.mTilesByTerrain);
     std::swap(mNextTileId, other.mNextTileId);
     std::swap(mTerrainTypes, other.mTerrainTypes);
     std::swap(mWangSets, other.mWangSets);
@@ -815,7 +879,7 @@ SharedTileset Tileset::clone() const
     c->mExpectedColumnCount = mExpectedColumnCount;
     c->mExpectedRowCount = mExpectedRowCount;
     c->mNextTileId = mNextTileId;
-    c->mTerrainDistancesDirty = mTerrainDistancesDirty;
+    c->mTerrainDistancesDirty = true;   // tilesByTerrain() needs to refer to the cloned tiles
     c->mStatus = mStatus;
     c->mBackgroundColor = mBackgroundColor;
     c->mFormat = mFormat;
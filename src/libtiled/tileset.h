@@ -33,6 +33,7 @@
 #include "object.h"
 
 #include <QColor>
+#include <QHash>
 #include <QList>
 #include <QPixmap>
 #include <QPoint>
@@ -183,6 +184,7 @@ public:
 
     int terrainTransitionPenalty(int terrainType0, int terrainType1) const;
     int maximumTerrainDistance() const;
+    const QHash<unsigned, QVector<Tile*>> &tilesByTerrain() const;
 
     const QList<WangSet*> &wangSets() const;
     int wangSetCount() const;
@@ -204,6 +206,7 @@ public:
     void setTileImage(Tile *tile,
                       const QPixmap &image,
                       const QUrl &source = QUrl());
+    bool setPendingTileImage(Tile *tile, const QUrl &source);
 
     void markTerrainDistancesDirty();
 
@@ -237,6 +240,7 @@ public:
 
 private:
     void updateTileSize();
+    void tileImageSizeChanged(QSize previousImageSize, QSize newImageSize);
     void recalculateTerrainDistances();
 
     QString mName;
@@ -255,6 +259,7 @@ private:
     int mNextTileId;
     int mMaximumTerrainDistance;
     QMap<int, Tile*> mTiles;
+    QHash<unsigned, QVector<Tile*>> mTilesByTerrain;
     QList<Terrain*> mTerrainTypes;
     QList<WangSet*> mWangSets;
     bool mTerrainDistancesDirty;
@@ -599,7 +604,8 @@ inline int Tileset::takeNextTileId()
 }
 
 /**
- * Used by the Tile class when its terrain information changes.
+ * Used by the Tile class when its terrain information changes. Also marks
+ * the index returned by tilesByTerrain() as outdated.
  */
 inline void Tileset::markTerrainDistancesDirty()
 {
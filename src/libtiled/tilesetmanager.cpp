@@ -35,6 +35,8 @@
 #include "tileanimationdriver.h"
 #include "tilesetformat.h"
 
+#include <QThread>
+
 #include "qtcompat_p.h"
 
 namespace Tiled {
@@ -60,12 +62,16 @@ TilesetManager::TilesetManager():
 
     connect(mAnimationDriver, &TileAnimationDriver::update,
             this, &TilesetManager::advanceTileAnimations);
+
+    ImageCache::setPreloadReceiver(this, "imagePreloaded");
 }
 
 TilesetManager::~TilesetManager()
 {
     // Assert that there are no remainingʣµ tileset instances
     Q_ASSERT(mTilesets.isEmpty());
+
+    ImageCache::setPreloadReceiver(nullptr, nullptr);
 }
 
 /**
@@ -125,8 +131,17 @@ SharedTileset TilesetManager::findTileset(const QString &fileName) const
  */
 void TilesetManager::addTileset(Tileset *tileset)
 {
-    Q_ASSERT(!mTilesets.contains(tileset));
+    // Tilesets created while reading a map on a worker thread are added by
+    // MapReader::loadDeferred instead
+    if (QThread::currentThread() != thread())
+        return;
+    if (mTilesets.contains(tileset))
+        return;
+
     mTilesets.append(tileset);
+
+    if (tileset->imageSource().isLocalFile())
+        mWatcher->addPath(tileset->imageSource().toLocalFile());
 }
 
 /**
@@ -136,11 +151,31 @@ void TilesetManager::addTileset(Tileset *tileset)
  */
 void TilesetManager::removeTileset(Tileset *tileset)
 {
-    Q_ASSERT(mTilesets.contains(tileset));
-    mTilesets.removeOne(tileset);
+    // Tilesets read on a worker thread may never have been added
+    if (QThread::currentThread() != thread())
+        return;
+    if (!mTilesets.removeOne(tileset))
+        return;
 
     if (tileset->imageSource().isLocalFile())
         mWatcher->removePath(tileset->imageSource().toLocalFile());
+
+    QMutableHashIterator<QString, Tileset*> it(mTilesetsAwaitingImages);
+    while (it.hasNext()) {
+        if (it.next().value() == tileset)
+            it.remove();
+    }
+}
+
+/**
+ * Makes sure repaintTileset() is emitted for the given \a tileset once the
+ * image in \a imageFileName has been preloaded.
+ */
+void TilesetManager::repaintTilesetWhenLoaded(Tileset *tileset,
+                                              const QString &imageFileName)
+{
+    if (!mTilesetsAwaitingImages.contains(imageFileName, tileset))
+        mTilesetsAwaitingImages.insert(imageFileName, tileset);
 }
 
 /**ǿtileset ¼
@@ -199,7 +234,11 @@ bool TilesetManager::animateTiles() const
 void TilesetManager::tilesetImageSourceChanged(const Tileset &tileset,
                                                const QUrl &oldImageSource)
 {
-    Q_ASSERT(mTilesets.contains(const_cast<Tileset*>(&tileset)));
+    // The image is watched once the tileset has been added
+    if (QThread::currentThread() != thread())
+        return;
+    if (!mTilesets.contains(const_cast<Tileset*>(&tileset)))
+        return;
 
     if (oldImageSource.isLocalFile())
         mWatcher->removePath(oldImageSource.toLocalFile());
@@ -260,6 +299,15 @@ void TilesetManager::resetTileAnimations()
     }
 }
 
+void TilesetManager::imagePreloaded(const QString &fileName)
+{
+    const QList<Tileset*> tilesets = mTilesetsAwaitingImages.values(fileName);
+    mTilesetsAwaitingImages.remove(fileName);
+
+    for (Tileset *tileset : tilesets)
+        emit repaintTileset(tileset);
+}
+
 void TilesetManager::advanceTileAnimations(int ms)
 {
     // TODO: This could be more optimal by keeping track of the list of actually animated tiles
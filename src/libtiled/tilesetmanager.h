@@ -33,6 +33,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QMultiHash>
 #include <QString>
 #include <QSet>
 #include <QTimer>
@@ -64,6 +65,8 @@ public:
 
     void reloadImages(Tileset *tileset);
 
+    void repaintTilesetWhenLoaded(Tileset *tileset, const QString &imageFileName);
+
     void setReloadTilesetsOnChange(bool enabled);
     bool reloadTilesetsOnChange() const;
 
@@ -92,6 +95,8 @@ private slots:
 
     void advanceTileAnimations(int ms);
 
+    void imagePreloaded(const QString &fileName);
+
 private:
     Q_DISABLE_COPY(TilesetManager)
 
@@ -107,6 +112,7 @@ private:
     FileSystemWatcher *mWatcher;
     TileAnimationDriver *mAnimationDriver;
     QSet<QString> mChangedFiles;
+    QMultiHash<QString, Tileset*> mTilesetsAwaitingImages;
     QTimer mChangedFilesTimer;
     bool mReloadTilesetsOnChange;//reload tileset on change
 };
@@ -164,7 +164,7 @@ Properties VariantToMapConverter::toProperties(const QVariant &propertiesVariant
             type = QVariant::String;
 
         const QVariant value = fromExportValue(it.value(), type, mMapDir);
-        properties[it.key()] = value;
+        properties[mPropertiesPool.name(it.key())] = value;
     }
 
     // read array-based format (1.2)
@@ -177,10 +177,10 @@ Properties VariantToMapConverter::toProperties(const QVariant &propertiesVariant
         int type = nameToType(propertyType);
         if (type == QVariant::Invalid)
             type = QVariant::String;
-        properties[propertyName] = fromExportValue(propertyValue, type, mMapDir);
+        properties[mPropertiesPool.name(propertyName)] = fromExportValue(propertyValue, type, mMapDir);
     }
 
-    return properties;
+    return mPropertiesPool.share(properties);
 }
 
 SharedTileset VariantToMapConverter::toTileset(const QVariant &variant)
@@ -294,7 +294,8 @@ SharedTileset VariantToMapConverter::toTileset(const QVariant &variant)
         QVariant imageVariant = tileVar[QLatin1String("image")];
         if (!imageVariant.isNull()) {
             const QUrl imagePath = toUrl(imageVariant.toString(), mMapDir);
-            tileset->setTileImage(tile, QPixmap(imagePath.toLocalFile()), imagePath);
+            if (!tileset->setPendingTileImage(tile, imagePath))
+                tileset->setTileImage(tile, QPixmap(imagePath.toLocalFile()), imagePath);
         }
 
         QVariantMap objectGroupVariant = tileVar[QLatin1String("objectgroup")].toMap();
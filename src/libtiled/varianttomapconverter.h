@@ -113,6 +113,7 @@ private:
     QDir mMapDir;
     bool mReadingExternalTileset;
     GidMapper mGidMapper;
+    mutable PropertiesPool mPropertiesPool;   // shares properties between objects
     QString mError;
 };
 
@@ -29,10 +29,127 @@
 #include "wangset.h"
 
 #include <QStack>
+#include <QtAlgorithms>
 #include <QtMath>
 
+#include <algorithm>
+
 using namespace Tiled;
 
+namespace Tiled {
+
+/**
+ * An index over the Wang tiles of a Wang set, for finding all the tiles
+ * matching a WangId in which zeros are wildcards.
+ *
+ * For each of the 8 positions in a WangId and each color, it stores a bitset
+ * marking the tiles that have this color at this position. A lookup
+ * intersects the bitsets of the positions that are not wildcards, so it does
+ * not need to enumerate the variations of the WangId.
+ */
+class WangIdIndex
+{
+public:
+    explicit WangIdIndex(const QMultiHash<WangId, WangTile> &wangTiles);
+
+    QList<WangTile> findMatching(WangId wangId) const;
+    bool hasMatch(WangId wangId) const;
+
+private:
+    template<typename Callback>
+    void forEachMatch(WangId wangId, Callback callback) const;
+
+    enum { Positions = 8, Colors = 16 };
+
+    const quint64 *bits(int position, int color) const
+    { return mBits.constData() + (position * Colors + color) * mWordCount; }
+
+    QVector<WangTile> mWangTiles;
+    int mWordCount;
+    QVector<quint64> mBits;
+};
+
+} // namespace Tiled
+
+WangIdIndex::WangIdIndex(const QMultiHash<WangId, WangTile> &wangTiles)
+{
+    mWangTiles.reserve(wangTiles.size());
+    for (const WangTile &wangTile : wangTiles)
+        mWangTiles.append(wangTile);
+
+    // Sort the tiles for a stable order of the results
+    std::sort(mWangTiles.begin(), mWangTiles.end(),
+              [] (const WangTile &a, const WangTile &b) {
+        if (a.wangId() != b.wangId())
+            return unsigned(a.wangId()) < unsigned(b.wangId());
+        return a.tile()->id() < b.tile()->id();
+    });
+
+    mWordCount = (mWangTiles.size() + 63) / 64;
+    mBits.fill(0, Positions * Colors * mWordCount);
+
+    for (int i = 0; i < mWangTiles.size(); ++i) {
+        const WangId wangId = mWangTiles.at(i).wangId();
+        for (int position = 0; position < Positions; ++position) {
+            const int color = wangId.indexColor(position);
+            quint64 *word = mBits.data() + (position * Colors + color) * mWordCount + i / 64;
+            *word |= quint64(1) << (i % 64);
+        }
+    }
+}
+
+/**
+ * Calls \a callback with the index of each tile matching the given
+ * \a wangId, until it returns false.
+ */
+template<typename Callback>
+void WangIdIndex::forEachMatch(WangId wangId, Callback callback) const
+{
+    const quint64 *sets[Positions];
+    int setCount = 0;
+
+    for (int position = 0; position < Positions; ++position)
+        if (const int color = wangId.indexColor(position))
+            sets[setCount++] = bits(position, color);
+
+    for (int w = 0; w < mWordCount; ++w) {
+        quint64 word = ~quint64(0);
+
+        if (setCount == 0 && w == mWordCount - 1 && mWangTiles.size() % 64)
+            word = (quint64(1) << (mWangTiles.size() % 64)) - 1;
+
+        for (int s = 0; s < setCount && word; ++s)
+            word &= sets[s][w];
+
+        while (word) {
+            const int bit = qCountTrailingZeroBits(word);
+            if (!callback(w * 64 + bit))
+                return;
+            word &= word - 1;
+        }
+    }
+}
+
+QList<WangTile> WangIdIndex::findMatching(WangId wangId) const
+{
+    QList<WangTile> list;
+    forEachMatch(wangId, [&] (int index) {
+        list.append(mWangTiles.at(index));
+        return true;
+    });
+    return list;
+}
+
+bool WangIdIndex::hasMatch(WangId wangId) const
+{
+    bool found = false;
+    forEachMatch(wangId, [&] (int) {
+        found = true;
+        return false;
+    });
+    return found;
+}
+
 unsigned cellToTileInfo(const Cell &cell)
 {
     return cell.tileId()
@@ -572,6 +689,7 @@ void WangSet::addWangTile(const WangTile &wangTile)
 
     mWangIdToWangTile.insert(wangTile.wangId(), wangTile);
     mTileInfoToWangId.insert(wangTileToTileInfo(wangTile), wangTile.wangId());
+    mWangIdIndex.reset();
 }
 
 void WangSet::removeWangTile(const WangTile &wangTile)
@@ -582,6 +700,7 @@ void WangSet::removeWangTile(const WangTile &wangTile)
     w.setWangId(wangId);
 
     mWangIdToWangTile.remove(wangId, w);
+    mWangIdIndex.reset();
 
     if (wangId
             && !mWangIdToWangTile.contains(wangId)
@@ -602,17 +721,19 @@ QList<WangTile> WangSet::findMatchingWangTiles(WangId wangId) const
     if (wangId == 0)
         return mWangIdToWangTile.values();
 
-    QList<WangTile> list;
-
-    for (WangId id : wangId.variations(edgeColorCount(), cornerColorCount())) {
-        auto i = mWangIdToWangTile.find(id);
-        while (i != mWangIdToWangTile.end() && i.key() == id) {
-            list.append(i.value());
-            ++i;
-        }
-    }
+    return wangIdIndex().findMatching(wangId);
+}
 
-    return list;
+/**
+ * Returns the index used for finding the tiles matching a WangId with
+ * wildcards. The index is created when it is first needed after the Wang
+ * tiles have changed.
+ */
+const WangIdIndex &WangSet::wangIdIndex() const
+{
+    if (!mWangIdIndex)
+        mWangIdIndex = QSharedPointer<const WangIdIndex>(new WangIdIndex(mWangIdToWangTile));
+    return *mWangIdIndex;
 }
 
 WangId WangSet::wangIdFromSurrounding(WangId surroundingWangIds[]) const
@@ -738,12 +859,7 @@ bool WangSet::wildWangIdIsUsed(WangId wangId) const
     if (!wangId)
         return true;
 
-    for (WangId id : wangId.variations(edgeColorCount(), cornerColorCount())) {
-        if (wangIdIsUsed(id))
-            return true;
-    }
-
-    return false;
+    return wangIdIndex().hasMatch(wangId);
 }
 
 bool WangSet::isComplete() const
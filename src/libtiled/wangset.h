@@ -38,6 +38,7 @@
 
 namespace Tiled {
 
+class WangIdIndex;
 class WangIdVariations;
 
 class TILEDSHARED_EXPORT WangId
@@ -421,6 +422,7 @@ public:
 
 private:
     void removeWangTile(const WangTile &wangTile);
+    const WangIdIndex &wangIdIndex() const;
 
     void insertEdgeWangColor(const QSharedPointer<WangColor> &wangColor);
     void insertCornerWangColor(const QSharedPointer<WangColor> &wangColor);
@@ -439,6 +441,10 @@ private:
     // Tile info being the tileId, with the last three bits (32, 31, 30)
     // being info on flip (horizontal, vertical, and antidiagonal)
     QHash<unsigned, WangId> mTileInfoToWangId;
+
+    // Lookup structure for finding tiles matching a WangId with wildcards,
+    // created when needed and discarded when the Wang tiles change
+    mutable QSharedPointer<const WangIdIndex> mWangIdIndex;
 };
 
 } // namespace Tiled
@@ -37,6 +37,8 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 #include "qtcompat_p.h"
 
 namespace Tiled {
@@ -55,6 +57,9 @@ WorldManager::WorldManager()
         mReloadTimer.start();
     });
 
+    connect(&mFileSystemWatcher, &QFileSystemWatcher::directoryChanged,
+            this, &WorldManager::directoryChanged);
+
     connect(&mReloadTimer, &QTimer::timeout,
             this, &WorldManager::reloadChangedWorldFiles);
 }
@@ -86,7 +91,9 @@ void WorldManager::reloadChangedWorldFiles()
         if (mWorlds.contains(fileName)) {
             auto world = privateLoadWorld(fileName);
             if (world) {
-                delete mWorlds.take(fileName);
+                std::unique_ptr<World> previousWorld { mWorlds.take(fileName) };
+                unwatchDirectory(previousWorld.get());
+                watchDirectory(world.get());
                 mWorlds.insert(fileName, world.release());
 
                 changed = true;
@@ -94,10 +101,28 @@ void WorldManager::reloadChangedWorldFiles()
         }
     }
 
+    // Files may have been added to or removed from pattern-based worlds
+    for (const QString &path : qAsConst(mChangedDirectories)) {
+        for (World *world : qAsConst(mWorlds)) {
+            if (world->patterns.isEmpty() || world->directory() != path)
+                continue;
+
+            const QStringList entries = QDir(path).entryList(QDir::Files | QDir::Readable);
+            if (entries != world->directoryEntries) {
+                world->directoryEntries = entries;
+                world->updateMaps();
+                changed = true;
+            }
+        }
+    }
+
     mChangedWorldFiles.clear();
+    mChangedDirectories.clear();
 
-    if (changed)
+    if (changed) {
+        updateWorldsByMap();
         emit worldsChanged();
+    }
 }
 
 std::unique_ptr<World> WorldManager::privateLoadWorld(const QString &fileName,
@@ -166,9 +191,69 @@ std::unique_ptr<World> WorldManager::privateLoadWorld(const QString &fileName,
 
     world->onlyShowAdjacentMaps = object.value(QLatin1String("onlyShowAdjacentMaps")).toBool();
 
+    if (!world->patterns.isEmpty())
+        world->directoryEntries = dir.entryList(QDir::Files | QDir::Readable);
+
+    world->updateMaps();
+
     return world;
 }
 
+void WorldManager::directoryChanged(const QString &path)
+{
+    if (!mChangedDirectories.contains(path))
+        mChangedDirectories.append(path);
+    mReloadTimer.start();
+}
+
+/**
+ * Watches the directory of the given \a world for files being added or
+ * removed, when it uses patterns to find its maps.
+ */
+void WorldManager::watchDirectory(const World *world)
+{
+    if (world->patterns.isEmpty())
+        return;
+
+    const QString directory = world->directory();
+    if (!mFileSystemWatcher.directories().contains(directory))
+        mFileSystemWatcher.addPath(directory);
+}
+
+/**
+ * Stops watching the directory of the given \a world, unless another loaded
+ * world still depends on it.
+ */
+void WorldManager::unwatchDirectory(const World *world)
+{
+    if (world->patterns.isEmpty())
+        return;
+
+    const QString directory = world->directory();
+
+    for (const World *other : qAsConst(mWorlds))
+        if (other != world && !other->patterns.isEmpty() && other->directory() == directory)
+            return;
+
+    mFileSystemWatcher.removePath(directory);
+}
+
+/**
+ * Rebuilds the lookup of worlds by the file names of their maps. The first
+ * loaded world containing a map takes precedence.
+ */
+void WorldManager::updateWorldsByMap()
+{
+    mWorldsByMap.clear();
+
+    for (World *world : qAsConst(mWorlds)) {
+        for (const World::MapEntry &mapEntry : world->allMaps()) {
+            if (!mWorldsByMap.contains(mapEntry.fileName))
+                mWorldsByMap.insert(mapEntry.fileName, world);
+        }
+    }
+}
+
 /**
  * Loads the world with the given \a fileName.
  *
@@ -178,13 +263,19 @@ std::unique_ptr<World> WorldManager::privateLoadWorld(const QString &fileName,
 bool WorldManager::loadWorld(const QString &fileName, QString *errorString)
 {
     auto world = privateLoadWorld(fileName, errorString);
+    if (!world)
+        return false;
 
-    if (mWorlds.contains(fileName))
-        delete mWorlds.take(fileName);//delete World 
-    else
+    if (mWorlds.contains(fileName)) {
+        std::unique_ptr<World> previousWorld { mWorlds.take(fileName) };
+        unwatchDirectory(previousWorld.get());
+    } else {
         mFileSystemWatcher.addPath(fileName);
+    }
 
+    watchDirectory(world.get());
     mWorlds.insert(fileName, world.release());
+    updateWorldsByMap();
     emit worldsChanged();
 
     return true;
@@ -198,26 +289,124 @@ void WorldManager::unloadWorld(const QString &fileName)
     std::unique_ptr<World> world { mWorlds.take(fileName) };
     if (world) {
         mFileSystemWatcher.removePath(fileName);
+        unwatchDirectory(world.get());
+        updateWorldsByMap();
         emit worldsChanged();
     }
 }
 
 const World *WorldManager::worldForMap(const QString &fileName) const
 {
+    if (const World *world = mWorldsByMap.value(fileName))
+        return world;
+
+    // Patterns may match maps that were not in the directory listing
     for (auto world : mWorlds)
-        if (world->containsMap(fileName))
+        if (!world->patterns.isEmpty() && world->containsMap(fileName))
             return world;
 
     return nullptr;
 }
 
-bool World::containsMap(const QString &fileName) const
+/**
+ * Returns the directory containing the world file, in which the maps matching
+ * the patterns are looked up.
+ */
+QString World::directory() const
 {
-    for (const World::MapEntry &mapEntry : maps) {
-        if (mapEntry.fileName == fileName)
-            return true;
+    return QFileInfo(fileName).path();
+}
+
+static quint64 gridKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+static int floorDivide(int value, int divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+/**
+ * Returns the range of grid cells covered by the given \a rect.
+ */
+static QRect gridCells(const QRect &rect, QSize cellSize)
+{
+    return QRect(QPoint(floorDivide(rect.left(), cellSize.width()),
+                        floorDivide(rect.top(), cellSize.height())),
+                 QPoint(floorDivide(rect.right(), cellSize.width()),
+                        floorDivide(rect.bottom(), cellSize.height())));
+}
+
+static QRect patternMapRect(const World::Pattern &pattern,
+                            const QRegularExpressionMatch &match)
+{
+    const int x = match.capturedRef(1).toInt();
+    const int y = match.capturedRef(2).toInt();
+
+    return QRect(QPoint(x * pattern.multiplierX,
+                        y * pattern.multiplierY) + pattern.offset,
+                 pattern.mapSize);
+}
+
+/**
+ * Resolves the maps matching the patterns against the directory entries and
+ * indexes all maps by file name and location, so that the world can be
+ * queried without matching any patterns.
+ *
+ * Needs to be called after changing the maps, patterns or directory entries.
+ */
+void World::updateMaps()
+{
+    resolvedMaps = maps;
+
+    if (!patterns.isEmpty()) {
+        const QDir dir(directory());
+
+        for (const World::Pattern &pattern : qAsConst(patterns)) {
+            for (const QString &fileName : qAsConst(directoryEntries)) {
+                QRegularExpressionMatch match = pattern.regexp.match(fileName);
+                if (match.hasMatch()) {
+                    MapEntry entry;
+                    entry.fileName = dir.filePath(fileName);
+                    entry.rect = patternMapRect(pattern, match);
+                    resolvedMaps.append(entry);
+                }
+            }
+        }
     }
 
+    mapIndexByFileName.clear();
+    mapGrid.clear();
+
+    // When the grid cells are as large as the largest map, each map covers
+    // at most four cells
+    gridCellSize = QSize(1, 1);
+    for (const MapEntry &mapEntry : qAsConst(resolvedMaps))
+        gridCellSize = gridCellSize.expandedTo(mapEntry.rect.size());
+
+    // The first entry for a file takes precedence
+    for (int i = resolvedMaps.size() - 1; i >= 0; --i)
+        mapIndexByFileName.insert(resolvedMaps.at(i).fileName, i);
+
+    for (int i = 0; i < resolvedMaps.size(); ++i) {
+        const QRect &rect = resolvedMaps.at(i).rect;
+        if (rect.isEmpty())
+            continue;
+
+        const QRect cells = gridCells(rect, gridCellSize);
+        for (int y = cells.top(); y <= cells.bottom(); ++y)
+            for (int x = cells.left(); x <= cells.right(); ++x)
+                mapGrid[gridKey(x, y)].append(i);
+    }
+}
+
+bool World::containsMap(const QString &fileName) const
+{
+    if (mapIndexByFileName.contains(fileName))
+        return true;
+
+    // The file may match a pattern without having been listed
     for (const World::Pattern &pattern : patterns) {
         QRegularExpressionMatch match = pattern.regexp.match(fileName);
         if (match.hasMatch())
@@ -229,62 +418,52 @@ bool World::containsMap(const QString &fileName) const
 
 QRect World::mapRect(const QString &fileName) const
 {
-    for (const World::MapEntry &mapEntry : maps) {
-        if (mapEntry.fileName == fileName)
-            return mapEntry.rect;
-    }
+    const int index = mapIndexByFileName.value(fileName, -1);
+    if (index != -1)
+        return resolvedMaps.at(index).rect;
 
     for (const World::Pattern &pattern : patterns) {
         QRegularExpressionMatch match = pattern.regexp.match(fileName);
-        if (match.hasMatch()) {
-            const int x = match.capturedRef(1).toInt();
-            const int y = match.capturedRef(2).toInt();
-
-            return QRect(QPoint(x * pattern.multiplierX,
-                                y * pattern.multiplierY) + pattern.offset,
-                         pattern.mapSize);
-        }
+        if (match.hasMatch())
+            return patternMapRect(pattern, match);
     }
 
     return QRect();
 }
 
-QVector<World::MapEntry> World::allMaps() const
+QVector<World::MapEntry> World::mapsInRect(const QRect &rect) const
 {
-    QVector<World::MapEntry> all(maps);
+    QVector<World::MapEntry> maps;
 
-    if (!patterns.isEmpty()) {
-        const QDir dir(QFileInfo(fileName).dir());
-        const QStringList entries = dir.entryList(QDir::Files | QDir::Readable);
+    if (rect.isEmpty())
+        return maps;
 
-        for (const World::Pattern &pattern : patterns) {
-            for (const QString &fileName : entries) {
-                QRegularExpressionMatch match = pattern.regexp.match(fileName);
-                if (match.hasMatch()) {
-                    const int x = match.capturedRef(1).toInt();
-                    const int y = match.capturedRef(2).toInt();
+    const QRect cells = gridCells(rect, gridCellSize);
 
-                    MapEntry entry;
-                    entry.fileName = dir.filePath(fileName);
-                    entry.rect = QRect(QPoint(x * pattern.multiplierX,
-                                              y * pattern.multiplierY) + pattern.offset,
-                                       pattern.mapSize);
-                    all.append(entry);
-                }
-            }
+    // Checking each map is cheaper when the rect covers many cells
+    if (qint64(cells.width()) * cells.height() > resolvedMaps.size()) {
+        for (const World::MapEntry &mapEntry : resolvedMaps) {
+            if (mapEntry.rect.intersects(rect))
+                maps.append(mapEntry);
         }
+        return maps;
     }
 
-    return all;
-}
-
-QVector<World::MapEntry> World::mapsInRect(const QRect &rect) const
-{
-    const QVector<World::MapEntry> all(allMaps());
+    QVector<int> indices;
+    for (int y = cells.top(); y <= cells.bottom(); ++y) {
+        for (int x = cells.left(); x <= cells.right(); ++x) {
+            auto it = mapGrid.constFind(gridKey(x, y));
+            if (it != mapGrid.constEnd())
+                indices.append(it.value());
+        }
+    }
 
-    QVector<World::MapEntry> maps;
+    // Maps may cover multiple cells, and are returned in their original order
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
 
-    for (const World::MapEntry &mapEntry : all) {
+    for (int index : qAsConst(indices)) {
+        const World::MapEntry &mapEntry = resolvedMaps.at(index);
         if (mapEntry.rect.intersects(rect))
             maps.append(mapEntry);
     }
@@ -33,12 +33,14 @@
 
 #include <QCoreApplication>
 #include <QFileSystemWatcher>
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QPoint>
 #include <QRect>
 #include <QRegularExpression>
 #include <QSize>
+#include <QStringList>
 #include <QTimer>
 #include <QVector>
 
@@ -68,11 +70,25 @@ struct TILEDSHARED_EXPORT World
     QVector<Pattern> patterns;
     bool onlyShowAdjacentMaps;
 
+    // Files in the world's directory, kept up to date by the WorldManager
+    // and matched against the patterns
+    QStringList directoryEntries;
+
+    QString directory() const;
+
+    void updateMaps();
+
     bool containsMap(const QString &fileName) const;
     QRect mapRect(const QString &fileName) const;
-    QVector<MapEntry> allMaps() const;
+    const QVector<MapEntry> &allMaps() const { return resolvedMaps; }
     QVector<MapEntry> mapsInRect(const QRect &rect) const;
     QVector<MapEntry> contextMaps(const QString &fileName) const;
+
+    // Derived from the above by updateMaps()
+    QVector<MapEntry> resolvedMaps;
+    QHash<QString, int> mapIndexByFileName;
+    QHash<quint64, QVector<int>> mapGrid;
+    QSize gridCellSize;
 };
 
 class TILEDSHARED_EXPORT WorldManager : public QObject
@@ -96,6 +112,7 @@ signals:
 
 private slots:
     void reloadChangedWorldFiles();
+    void directoryChanged(const QString &path);
 
 private:
     WorldManager();
@@ -104,11 +121,17 @@ private:
     std::unique_ptr<World> privateLoadWorld(const QString &fileName,
                                             QString *errorString = nullptr);
 
+    void watchDirectory(const World *world);
+    void unwatchDirectory(const World *world);
+    void updateWorldsByMap();
+
     QMap<QString, World*> mWorlds;
+    QHash<QString, World*> mWorldsByMap;
 
     QFileSystemWatcher mFileSystemWatcher;
     QTimer mReloadTimer;
     QStringList mChangedWorldFiles;
+    QStringList mChangedDirectories;
 
     static WorldManager *mInstance;
 };
@@ -23,10 +23,10 @@
 #include "addremovetileset.h"
 #include "changemapobject.h"
 #include "documentmanager.h"
+#include "geometry.h"
 #include "mapdocument.h"
 #include "map.h"
 #include "mapobject.h"
-#include "mapobjectitem.h"
 #include "maprenderer.h"
 #include "mapscene.h"
 #include "objectgroup.h"
@@ -47,6 +47,8 @@
 
 #include <QtMath>
 
+#include <algorithm>
+
 using namespace Tiled;
 using namespace Tiled::Internal;
 
@@ -205,35 +207,96 @@ ObjectGroup *AbstractObjectTool::currentObjectGroup() const
     return dynamic_cast<ObjectGroup*>(mapDocument()->currentLayer());//ObjectGroup-->layer
 }
 
-QList<MapObject*> AbstractObjectTool::mapObjectsAt(const QPointF &pos) const
+/**
+ * Returns the unlocked and visible objects of the current map whose shape
+ * contains (when \a isPoint is set) or intersects the given \a area, in
+ * scene coordinates. The top-most object comes first.
+ *
+ * Instead of asking the scene for the items at a certain location, this uses
+ * the spatial index of each object group to find the candidate objects.
+ */
+QList<MapObject*> AbstractObjectTool::mapObjectsIn(const QRectF &area,
+                                                   bool isPoint) const
 {
-    const QList<QGraphicsItem *> &items = mMapScene->items(pos);
-
     QList<MapObject*> objectList;
-    for (auto item : items) {
-        if (!item->isEnabled())
+
+    if (!mapDocument())
+        return objectList;
+
+    const MapRenderer *renderer = mapDocument()->renderer();
+    const QPainterPath areaPath = [&] {
+        QPainterPath path;
+        path.addRect(area);
+        return path;
+    }();
+
+    LayerIterator iterator(mapDocument()->map(), Layer::ObjectGroupType);
+    iterator.toBack();
+
+    while (Layer *layer = iterator.previous()) {
+        if (layer->isHidden() || !layer->isUnlocked())
             continue;
 
-        MapObjectItem *objectItem = qgraphicsitem_cast<MapObjectItem*>(item);
-        if (objectItem && objectItem->mapObject()->objectGroup()->isUnlocked())
-            objectList.append(objectItem->mapObject());
+        ObjectGroup *objectGroup = static_cast<ObjectGroup*>(layer);
+        const QPointF offset = objectGroup->totalOffset();
+
+        // Point objects are displayed as a marker above their position
+        const QRectF screenArea = area.translated(-offset).adjusted(-10, 0, 10, 30);
+        const QPolygonF pixelArea = renderer->screenToPixelCoords(QPolygonF(screenArea));
+
+        QList<MapObject*> candidates = objectGroup->objectsInRect(pixelArea.boundingRect());
+        if (candidates.isEmpty())
+            continue;
+
+        QList<MapObject*> hits;
+        QHash<MapObject*, qreal> screenY;
+
+        for (MapObject *object : qAsConst(candidates)) {
+            if (!object->isVisible())
+                continue;
+
+            const QPointF screenPos = renderer->pixelToScreenCoords(object->position());
+            QPainterPath shape = rotateAt(screenPos, object->rotation()).map(renderer->shape(object));
+            shape.translate(offset);
+
+            const bool hit = isPoint ? shape.contains(area.topLeft())
+                                     : shape.intersects(areaPath);
+            if (hit) {
+                hits.append(object);
+                screenY.insert(object, screenPos.y());
+            }
+        }
+
+        // Sort the objects so that the top-most one comes first
+        if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder) {
+            std::sort(hits.begin(), hits.end(), [&] (MapObject *a, MapObject *b) {
+                const qreal ya = screenY.value(a);
+                const qreal yb = screenY.value(b);
+                if (ya != yb)
+                    return ya > yb;
+                return a->index() > b->index();
+            });
+        } else {
+            std::sort(hits.begin(), hits.end(), [] (MapObject *a, MapObject *b) {
+                return a->index() > b->index();
+            });
+        }
+
+        objectList.append(hits);
     }
+
     return objectList;
 }
 
-MapObject *AbstractObjectTool::topMostMapObjectAt(const QPointF &pos) const
+QList<MapObject*> AbstractObjectTool::mapObjectsAt(const QPointF &pos) const
 {
-    const QList<QGraphicsItem *> &items = mMapScene->items(pos);
-
-    for (QGraphicsItem *item : items) {
-        if (!item->isEnabled())
-            continue;
+    return mapObjectsIn(QRectF(pos, QSizeF(0, 0)), true);
+}
 
-        MapObjectItem *objectItem = qgraphicsitem_cast<MapObjectItem*>(item);
-        if (objectItem && objectItem->mapObject()->objectGroup()->isUnlocked())
-            return objectItem->mapObject();
-    }
-    return nullptr;
+MapObject *AbstractObjectTool::topMostMapObjectAt(const QPointF &pos) const
+{
+    const QList<MapObject*> objects = mapObjectsAt(pos);
+    return objects.isEmpty() ? nullptr : objects.first();
 }
 
 void AbstractObjectTool::duplicateObjects()//ƶ
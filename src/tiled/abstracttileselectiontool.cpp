@@ -90,21 +90,23 @@ void AbstractTileSelectionTool::mousePressed(QGraphicsSceneMouseEvent *event)
 
     MapDocument *document = mapDocument();
 
-    QRegion selection;
+    BitmapRegion selection;
 
     // Left button modifies selection, right button clears selection
     if (button == Qt::LeftButton) {
-        selection = document->selectedArea();
+        selection = document->selectedCells();
+
+        const BitmapRegion selectedRegion(mSelectedRegion);
 
         switch (mSelectionMode) {
-        case Replace:   selection = mSelectedRegion; break;
-        case Add:       selection += mSelectedRegion; break;
-        case Subtract:  selection -= mSelectedRegion; break;
-        case Intersect: selection &= mSelectedRegion; break;
+        case Replace:   selection = selectedRegion; break;
+        case Add:       selection += selectedRegion; break;
+        case Subtract:  selection -= selectedRegion; break;
+        case Intersect: selection &= selectedRegion; break;
         }
     }
 
-    if (selection != document->selectedArea()) {
+    if (selection != document->selectedCells()) {
         QUndoCommand *cmd = new ChangeSelectedArea(document, selection);
         document->undoStack()->push(cmd);
     }
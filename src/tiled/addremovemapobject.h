@@ -20,7 +20,10 @@
 
 #pragma once
 
+#include "mapobjectmodel.h"
+
 #include <QUndoCommand>
+#include <QVector>
 
 namespace Tiled {
 
@@ -85,5 +88,60 @@ public:
     { removeObject(); }
 };
 
+/**
+ * Abstract base class for AddMapObjects and RemoveMapObjects. The objects are
+ * added or removed in bulk, so that the model signals are emitted once per
+ * contiguous range of objects rather than once per object.
+ */
+class AddRemoveMapObjects : public QUndoCommand
+{
+public:
+    AddRemoveMapObjects(MapDocument *mapDocument,
+                        const QVector<MapObjectModel::ObjectEntry> &entries,
+                        bool ownObjects,
+                        QUndoCommand *parent = nullptr);
+    ~AddRemoveMapObjects();
+
+protected:
+    void addObjects();
+    void removeObjects();
+
+private:
+    MapDocument *mMapDocument;
+    QVector<MapObjectModel::ObjectEntry> mEntries;
+    bool mOwnsObjects;
+};
+
+/**
+ * Undo command that adds a number of objects to a map.
+ */
+class AddMapObjects : public AddRemoveMapObjects
+{
+public:
+    AddMapObjects(MapDocument *mapDocument,
+                  const QVector<MapObjectModel::ObjectEntry> &entries,
+                  QUndoCommand *parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+};
+
+/**
+ * Undo command that removes a number of objects from a map.
+ */
+class RemoveMapObjects : public AddRemoveMapObjects
+{
+public:
+    RemoveMapObjects(MapDocument *mapDocument,
+                     const QList<MapObject*> &mapObjects,
+                     QUndoCommand *parent = nullptr);
+
+    void undo() override
+    { addObjects(); }
+
+    void redo() override
+    { removeObjects(); }
+};
+
 } // namespace Internal
 } // namespace Tiled
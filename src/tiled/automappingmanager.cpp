@@ -94,8 +94,11 @@ void AutomappingManager::autoMapInternal(const QRegion &where,
     const bool automatic = touchedLayer != nullptr;
 
     if (!mLoaded) {
-        const QString mapPath = QFileInfo(mMapDocument->fileName()).path();
-        const QString rulesFileName = mapPath + QLatin1String("/rules.txt");
+        QString rulesFileName = mRulesFileName;
+        if (rulesFileName.isEmpty()) {
+            const QString mapPath = QFileInfo(mMapDocument->fileName()).path();
+            rulesFileName = mapPath + QLatin1String("/rules.txt");
+        }
         if (loadFile(rulesFileName)) {
             mLoaded = true;
         } else {
@@ -218,6 +221,16 @@ void AutomappingManager::setMapDocument(MapDocument *mapDocument)
     mLoaded = false;
 }
 
+void AutomappingManager::setRulesFileName(const QString &fileName)
+{
+    if (mRulesFileName == fileName)
+        return;
+
+    cleanUp();
+    mRulesFileName = fileName;
+    mLoaded = false;
+}
+
 void AutomappingManager::cleanUp()
 {
     qDeleteAll(mAutoMappers);
@@ -54,6 +54,12 @@ public:
 
     void setMapDocument(MapDocument *mapDocument);
 
+    /**
+     * Sets the rules file to use instead of the "rules.txt" next to the map
+     * file. An empty \a fileName restores the default.
+     */
+    void setRulesFileName(const QString &fileName);
+
     QString errorString() const { return mError; }
 
     QString warningString() const { return mWarning; }
@@ -113,6 +119,11 @@ private:
      */
     MapDocument *mMapDocument;
 
+    /**
+     * Overrides the rules file looked up next to the map, when not empty.
+     */
+    QString mRulesFileName;
+
     /**
      * For each new file of rules a new AutoMapper is setup. In this vector we
      * can store all of the AutoMappers in order.
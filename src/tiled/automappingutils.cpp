@@ -22,24 +22,68 @@
 #include "automappingutils.h"
 
 #include "addremovemapobject.h"
+#include "map.h"
 #include "mapdocument.h"
 #include "mapobject.h"
 #include "maprenderer.h"
 #include "objectgroup.h"
 
+#include <QPolygonF>
 #include <QUndoStack>
+#include <QVector>
+
+#include <algorithm>
 
 namespace Tiled {
 namespace Internal {
 
+/**
+ * Returns the area in pixel coordinates covered by the given tile \a rect,
+ * extended by one tile in each direction.
+ */
+static QRectF tileRectToPixelArea(const MapRenderer *renderer,
+                                  const Map *map,
+                                  const QRect &rect)
+{
+    const QRectF tileRect(rect.x(), rect.y(), rect.width() + 1, rect.height() + 1);
+    const QPolygonF corners = QPolygonF()
+            << renderer->tileToPixelCoords(tileRect.topLeft())
+            << renderer->tileToPixelCoords(tileRect.topRight())
+            << renderer->tileToPixelCoords(tileRect.bottomRight())
+            << renderer->tileToPixelCoords(tileRect.bottomLeft());
+
+    const int margin = qMax(map->tileWidth(), map->tileHeight());
+    return corners.boundingRect().adjusted(-margin, -margin, margin, margin);
+}
+
+/**
+ * Sorts the given \a objects by their position in their object group, since
+ * the spatial index returns them in order of their ID.
+ */
+static void sortByLayerOrder(QList<MapObject*> &objects)
+{
+    std::sort(objects.begin(), objects.end(),
+              [] (const MapObject *a, const MapObject *b) { return a->index() < b->index(); });
+}
+
 void eraseRegionObjectGroup(MapDocument *mapDocument,
                             ObjectGroup *layer,
                             const QRegion &where)
 {
+    if (where.isEmpty())
+        return;
+
     QUndoStack *undo = mapDocument->undoStack();
 
-    const auto objects = layer->objects();
-    for (MapObject *obj : objects) {
+    // Use the spatial index to skip objects that are far away
+    const QRectF area = tileRectToPixelArea(mapDocument->renderer(),
+                                            mapDocument->map(),
+                                            where.boundingRect());
+
+    QList<MapObject*> objects = layer->objectsInRect(area);
+    sortByLayerOrder(objects);
+
+    for (MapObject *obj : qAsConst(objects)) {
         // TODO: we are checking bounds, which is only correct for rectangles and
         // tile objects. polygons and polylines are not covered correctly by this
         // erase method (we are in fact deleting too many objects)
@@ -66,21 +110,44 @@ void eraseRegionObjectGroup(MapDocument *mapDocument,
 //еש
 QRegion tileRegionOfObjectGroup(const ObjectGroup *layer)
 {
-    QRegion ret;
+    QVector<QRegion> regions;
+    regions.reserve(layer->objectCount());
+
     for (MapObject *obj : layer->objects()) {
         // TODO: we are using bounds, which is only correct for rectangles and
         // tile objects. polygons and polylines are not probably covering less
         // tiles.
-        ret += obj->bounds().toAlignedRect();
+        regions.append(obj->bounds().toAlignedRect());
     }
-    return ret;
+
+    // Unite pairwise, since adding rectangles one at a time to an ever
+    // growing region is quadratic in the number of objects.
+    while (regions.size() > 1) {
+        int count = 0;
+        for (int i = 0; i < regions.size(); i += 2) {
+            if (i + 1 < regions.size())
+                regions[count++] = regions.at(i).united(regions.at(i + 1));
+            else
+                regions[count++] = regions.at(i);
+        }
+        regions.resize(count);
+    }
+
+    return regions.isEmpty() ? QRegion() : regions.first();
 }
 //
 const QList<MapObject*> objectsInRegion(const ObjectGroup *layer,
                                         const QRegion &where)
 {
     QList<MapObject*> ret;
-    for (MapObject *obj : layer->objects()) {
+    if (where.isEmpty())
+        return ret;
+
+    // Use the spatial index to skip objects that are far away
+    const QRectF area = QRectF(where.boundingRect()).adjusted(-1, -1, 1, 1);
+
+    const auto candidates = layer->objectsInRect(area);
+    for (MapObject *obj : candidates) {
         // TODO: we are checking bounds, which is only correct for rectangles and
         // tile objects. polygons and polylines are not covered correctly by this
         // erase method (we are in fact deleting too many objects)
@@ -93,6 +160,8 @@ const QList<MapObject*> objectsInRegion(const ObjectGroup *layer,
         if (where.intersects(rect) || where.contains(rect.topLeft()))
             ret += obj;
     }
+
+    sortByLayerOrder(ret);
     return ret;
 }
 
@@ -0,0 +1,78 @@
+/*
+ * backgroundmapreader.cpp
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "backgroundmapreader.h"
+
+#include "map.h"
+#include "mapformat.h"
+
+#include <QThreadPool>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+BackgroundMapReader::BackgroundMapReader(const QString &fileName,
+                                         MapFormat *format)
+    : mFileName(fileName)
+    , mFormat(format)
+{
+    setAutoDelete(false);
+    mReader.setDeferLoading(true);
+}
+
+BackgroundMapReader::~BackgroundMapReader() = default;
+
+/**
+ * Starts reading the map on the global thread pool.
+ */
+void BackgroundMapReader::start()
+{
+    QThreadPool::globalInstance()->start(this);
+}
+
+void BackgroundMapReader::run()
+{
+    mMap.reset(mReader.readMap(mFileName));
+    emit finished();
+}
+
+/**
+ * Loads the tilesets, templates and images of the map that was read and
+ * returns a new document for it. Returns a null pointer and sets \a error
+ * when the map could not be read.
+ *
+ * Should only be called once, on the main thread.
+ */
+MapDocumentPtr BackgroundMapReader::takeMapDocument(QString *error)
+{
+    if (!mMap) {
+        if (error)
+            *error = mReader.errorString();
+        return MapDocumentPtr();
+    }
+
+    mReader.loadDeferred(mMap.get());
+
+    MapDocumentPtr document = MapDocumentPtr::create(mMap.release(), mFileName);
+    document->setReaderFormat(mFormat);
+    if (mFormat->hasCapabilities(MapFormat::Write))
+        document->setWriterFormat(mFormat);
+
+    return document;
+}
@@ -0,0 +1,82 @@
+/*
+ * backgroundmapreader.h
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "mapdocument.h"
+#include "mapreader.h"
+
+#include <QObject>
+#include <QRunnable>
+
+#include <memory>
+
+namespace Tiled {
+
+class Map;
+class MapFormat;
+
+namespace Internal {
+
+/**
+ * Reads a map in the TMX format on the global thread pool.
+ *
+ * The external tilesets, object templates and images used by the map are
+ * shared with the rest of the application, so they are only loaded by
+ * takeMapDocument(). It needs to be called on the main thread, after the
+ * finished() signal has been emitted.
+ *
+ * The reader is not deleted automatically. Connect finished() to
+ * deleteLater(), so it also gets deleted when nobody is interested in the
+ * result anymore.
+ */
+class BackgroundMapReader : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    BackgroundMapReader(const QString &fileName, MapFormat *format);
+    ~BackgroundMapReader() override;
+
+    const QString &fileName() const;
+
+    void start();
+
+    MapDocumentPtr takeMapDocument(QString *error = nullptr);
+
+signals:
+    void finished();
+
+protected:
+    void run() override;
+
+private:
+    const QString mFileName;
+    MapFormat * const mFormat;
+    MapReader mReader;
+    std::unique_ptr<Map> mMap;
+};
+
+inline const QString &BackgroundMapReader::fileName() const
+{
+    return mFileName;
+}
+
+} // namespace Internal
+} // namespace Tiled
@@ -88,7 +88,7 @@ SplitPolyline::SplitPolyline(MapDocument *mapDocument,
     , mEdgeIndex(index)
     , mOldChangeState(mapObject->propertyChanged(MapObject::ShapeProperty))
 {
-    mObjectIndex = mapObject->objectGroup()->objects().indexOf(mapObject) + 1;
+    mObjectIndex = mapObject->index() + 1;
     mSecondPolyline = mFirstPolyline->clone();
     mSecondPolyline->resetId();
 
@@ -37,6 +37,17 @@ ChangeSelectedArea::ChangeSelectedArea(MapDocument *mapDocument,
 {
 }
 
+ChangeSelectedArea::ChangeSelectedArea(MapDocument *mapDocument,
+                                       const BitmapRegion &newSelection,
+                                       QUndoCommand *parent)
+    : QUndoCommand(QCoreApplication::translate("Undo Commands",
+                                               "Change Selection"),
+                   parent)
+    , mMapDocument(mapDocument)
+    , mSelection(newSelection)
+{
+}
+
 void ChangeSelectedArea::undo()
 {
     swapSelection();
@@ -49,7 +60,7 @@ void ChangeSelectedArea::redo()
 
 void ChangeSelectedArea::swapSelection()
 {
-    const QRegion oldSelection = mMapDocument->selectedArea();
+    const BitmapRegion oldSelection = mMapDocument->selectedCells();
     mMapDocument->setSelectedArea(mSelection);
     mSelection = oldSelection;
 }
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include "bitmapregion.h"
+
 #include <QRegion>
 #include <QUndoCommand>
 
@@ -38,6 +40,9 @@ public:
     ChangeSelectedArea(MapDocument *mapDocument,
                        const QRegion &selection,
                        QUndoCommand *parent = nullptr);
+    ChangeSelectedArea(MapDocument *mapDocument,
+                       const BitmapRegion &selection,
+                       QUndoCommand *parent = nullptr);
 
     void undo() override;
     void redo() override;
@@ -46,7 +51,7 @@ private:
     void swapSelection();
 
     MapDocument *mMapDocument;
-    QRegion mSelection;
+    BitmapRegion mSelection;
 };
 
 } // namespace Internal
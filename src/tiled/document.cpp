@@ -21,9 +21,11 @@
 #include "document.h"
 
 #include "object.h"
+#include "preferences.h"
 #include "tile.h"
 
 #include <QFileInfo>
+#include <QTimer>
 #include <QUndoStack>
 
 namespace Tiled {
@@ -40,9 +42,14 @@ Document::Document(DocumentType type, const QString &fileName,
     , mCurrentObject(nullptr)
     , mChangedOnDisk(false)
     , mIgnoreBrokenLinks(false)
+    , mUndoMemoryUsage(0)
+    , mUndoMemoryCheckScheduled(false)
+    , mUndoHistoryDiscarded(false)
 {
     connect(mUndoStack, &QUndoStack::cleanChanged,
             this, &Document::modifiedChanged);
+    connect(Preferences::instance(), &Preferences::undoMemoryLimitChanged,
+            this, &Document::scheduleUndoMemoryCheck);
 
     sDocumentInstances.append(this);
 }
@@ -67,7 +74,65 @@ void Document::setFileName(const QString &fileName)
  */
 bool Document::isModified() const
 {
-    return !mUndoStack->isClean();//If the stack is in the clean state, returns true; otherwise returns false.
+    return mUndoHistoryDiscarded || !mUndoStack->isClean();//If the stack is in the clean state, returns true; otherwise returns false.
+}
+
+/**
+ * Marks the current state of the document as saved.
+ */
+void Document::setClean()
+{
+    mUndoStack->setClean();
+
+    if (mUndoHistoryDiscarded) {
+        mUndoHistoryDiscarded = false;
+        emit modifiedChanged();
+    }
+}
+
+/**
+ * Adjusts the memory used by the data stored in the undo stack by \a bytes.
+ * Commands storing large amounts of data report it when they are created,
+ * merged or deleted, so that it can be shown and limited without going over
+ * the whole stack.
+ */
+void Document::addUndoMemoryUsage(qint64 bytes)
+{
+    if (bytes == 0)
+        return;
+
+    mUndoMemoryUsage += bytes;
+    emit undoMemoryUsageChanged(mUndoMemoryUsage);
+
+    if (bytes > 0)
+        scheduleUndoMemoryCheck();
+}
+
+void Document::scheduleUndoMemoryCheck()
+{
+    if (mUndoMemoryCheckScheduled)
+        return;
+
+    // Check once the command being pushed or merged has been handled
+    mUndoMemoryCheckScheduled = true;
+    QTimer::singleShot(0, this, &Document::checkUndoMemoryLimit);
+}
+
+void Document::checkUndoMemoryLimit()
+{
+    mUndoMemoryCheckScheduled = false;
+
+    const qint64 limit = qint64(Preferences::instance()->undoMemoryLimit()) * 1024 * 1024;
+    if (limit <= 0 || mUndoMemoryUsage <= limit)
+        return;
+
+    // A QUndoStack can only drop its commands all at once. Dropping only the
+    // oldest ones would leave the remaining commands to be undone on top of
+    // a state that never existed.
+    if (isModified())
+        mUndoHistoryDiscarded = true;
+
+    mUndoStack->clear();
 }
 
 void Document::setCurrentObject(Object *object)
@@ -89,6 +89,10 @@ public:
 
     QUndoStack *undoStack() const;
     bool isModified() const;
+    void setClean();
+
+    qint64 undoMemoryUsage() const;
+    void addUndoMemoryUsage(qint64 bytes);
 
     Object *currentObject() const { return mCurrentObject; }
     void setCurrentObject(Object *object);
@@ -134,6 +138,8 @@ signals:
 
     void ignoreBrokenLinksChanged(bool ignoreBrokenLinks);
 
+    void undoMemoryUsageChanged(qint64 bytes);
+
 protected:
     void setFileName(const QString &fileName);
 
@@ -150,6 +156,13 @@ protected:
     QString mLastExportFileName;
 
 private:
+    void scheduleUndoMemoryCheck();
+    void checkUndoMemoryLimit();
+
+    qint64 mUndoMemoryUsage;
+    bool mUndoMemoryCheckScheduled;
+    bool mUndoHistoryDiscarded;     // Unsaved changes are no longer undoable
+
     static QList<Document*> sDocumentInstances;
 };
 
@@ -169,6 +182,15 @@ inline QUndoStack *Document::undoStack() const
     return mUndoStack;
 }
 
+/**
+ * Returns the memory used by the data stored in the undo stack, as reported
+ * by the commands through addUndoMemoryUsage().
+ */
+inline qint64 Document::undoMemoryUsage() const
+{
+    return mUndoMemoryUsage;
+}
+
 inline bool Document::ignoreBrokenLinks() const
 {
     return mIgnoreBrokenLinks;
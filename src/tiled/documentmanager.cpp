@@ -427,11 +427,14 @@ static bool isDocumentChangedOnDisk(Document *document)
     return document->changedOnDisk();
 }
 
-DocumentPtr DocumentManager::loadDocument(const QString &fileName,
-                                          FileFormat *fileFormat,
-                                          QString *error)
+/**
+ * Returns the document for the given file when it is already open, or is
+ * otherwise referenced, for example by a world. Returns a null pointer when
+ * the file has not been loaded.
+ */
+DocumentPtr DocumentManager::findLoadedDocument(const QString &fileName) const
 {
-    // Return existing document if this file is already open
+    // Return the document if this file is already open
     int documentIndex = findDocument(fileName);
     if (documentIndex != -1)
         return mDocuments.at(documentIndex);
@@ -445,6 +448,18 @@ DocumentPtr DocumentManager::loadDocument(const QString &fileName,
         }//If this (that is, the subclass instance invoking this method) is being managed by a QSharedPointer,
         //returns a shared pointer instance pointing to this; otherwise returns a QSharedPointer holding a null pointer.ָdocumentָ;򷵻һָQSharedPointer
     }
+
+    return DocumentPtr();
+}
+
+DocumentPtr DocumentManager::loadDocument(const QString &fileName,
+                                          FileFormat *fileFormat,
+                                          QString *error)
+{
+    // Return existing document if this file is already open or referenced
+    if (DocumentPtr document = findLoadedDocument(fileName))
+        return document;
+
     //mutable αΪױ,ʱconst档һĳԱıԾΪcount
     if (!fileFormat) {
         // Try to find a plugin that implements support for this formatӲҵʵ(ָ֧øʽ)
@@ -96,6 +96,7 @@ public:
 
     bool isDocumentModified(Document *document) const;
 
+    DocumentPtr findLoadedDocument(const QString &fileName) const;
     DocumentPtr loadDocument(const QString &fileName,
                              FileFormat *fileFormat = nullptr,
                              QString *error = nullptr);
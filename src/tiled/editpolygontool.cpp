@@ -28,7 +28,6 @@
 #include "map.h"
 #include "mapdocument.h"
 #include "mapobject.h"
-#include "mapobjectitem.h"
 #include "mapobjectmodel.h"
 #include "maprenderer.h"
 #include "mapscene.h"
@@ -210,22 +209,7 @@ void EditPolygonTool::mousePressed(QGraphicsSceneMouseEvent *event)
         mStart = event->scenePos();
         mScreenStart = event->screenPos();
 
-        const QList<QGraphicsItem *> items = mapScene()->items(mStart,
-                                                               Qt::IntersectsItemShape,
-                                                               Qt::DescendingOrder,
-                                                               viewTransform(event));
-
-        mClickedObject = nullptr;
-        for (QGraphicsItem *item : items) {
-            if (!item->isEnabled())
-                continue;
-            if (auto mapObjectItem = qgraphicsitem_cast<MapObjectItem*>(item)) {
-                if (mapObjectItem->mapObject()->objectGroup()->isUnlocked()) {
-                    mClickedObject = mapObjectItem->mapObject();
-                    break;
-                }
-            }
-        }
+        mClickedObject = topMostMapObjectAt(mStart);
         break;
     }
     case Qt::RightButton: {
@@ -475,17 +459,7 @@ void EditPolygonTool::updateSelection(QGraphicsSceneMouseEvent *event)
 
     if (mapDocument()->selectedObjects().isEmpty()) {
         // Allow selecting some map objects only when there aren't any selected
-        QList<MapObject*> selectedObjects;
-
-        for (QGraphicsItem *item : intersectedItems) {
-            if (!item->isEnabled())
-                continue;
-            auto mapObjectItem = qgraphicsitem_cast<MapObjectItem*>(item);
-            if (mapObjectItem && mapObjectItem->mapObject()->objectGroup()->isUnlocked())
-                selectedObjects.append(mapObjectItem->mapObject());
-        }
-
-        mapDocument()->setSelectedObjects(selectedObjects);
+        mapDocument()->setSelectedObjects(mapObjectsIn(rect));
     } else {
         // Update the selected handles
         QSet<PointHandle*> selectedHandles;
@@ -24,6 +24,7 @@
 #include "imagelayer.h"
 #include "map.h"
 #include "mapdocument.h"
+#include "mapimageexporter.h"
 #include "mapobject.h"
 #include "mapobjectitem.h"
 #include "maprenderer.h"
@@ -174,34 +175,46 @@ void ExportAsImageDialog::accept()//
     if (useCurrentScale)
         imageSize *= mCurrentScale;
 
-    try {
-        QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
-
-        if (image.isNull()) {
-            const size_t gigabyte = 1073741824;
-            const size_t memory = size_t(imageSize.width()) * size_t(imageSize.height()) * 4;
-            const double gigabytes = static_cast<double>(memory) / gigabyte;
-
+    // TIFF files are written in bands, so they don't need to fit in memory
+    if (MapImageExporter::isTiffFile(fileName)) {
+        MapImageExporter exporter(mMapDocument->map(), renderFlags);
+        if (!exporter.writeTiff(fileName, imageSize)) {
             QMessageBox::critical(this,
-                                  tr("Image too Big"),
-                                  tr("The resulting image would be %1 x %2 pixels and take %3 GB of memory. "
-                                     "Tiled is unable to create such an image. Try reducing the zoom level.")
-                                  .arg(imageSize.width())
-                                  .arg(imageSize.height())
-                                  .arg(gigabytes, 0, 'f', 2));
+                                  tr("Error Exporting Image"),
+                                  exporter.errorString());
+            return;
+        }
+    } else {
+        try {
+            QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
+
+            if (image.isNull()) {
+                const size_t gigabyte = 1073741824;
+                const size_t memory = size_t(imageSize.width()) * size_t(imageSize.height()) * 4;
+                const double gigabytes = static_cast<double>(memory) / gigabyte;
+
+                QMessageBox::critical(this,
+                                      tr("Image too Big"),
+                                      tr("The resulting image would be %1 x %2 pixels and take %3 GB of memory. "
+                                         "Tiled is unable to create such an image. Try reducing the zoom level "
+                                         "or exporting to a TIFF file.")
+                                      .arg(imageSize.width())
+                                      .arg(imageSize.height())
+                                      .arg(gigabytes, 0, 'f', 2));
+                return;
+            }
+
+            miniMapRenderer.renderToImage(image, renderFlags);
+
+            image.save(fileName);
+
+        } catch (const std::bad_alloc &) {
+            QMessageBox::critical(this,
+                                  tr("Out of Memory"),
+                                  tr("Could not allocate sufficient memory for the image. "
+                                     "Try reducing the zoom level or using a 64-bit version of Tiled."));
             return;
         }
-
-        miniMapRenderer.renderToImage(image, renderFlags);
-
-        image.save(fileName);
-
-    } catch (const std::bad_alloc &) {
-        QMessageBox::critical(this,
-                              tr("Out of Memory"),
-                              tr("Could not allocate sufficient memory for the image. "
-                                 "Try reducing the zoom level or using a 64-bit version of Tiled."));
-        return;
     }
 
     mPath = QFileInfo(fileName).path();
@@ -20,28 +20,48 @@
  * this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "automappingmanager.h"
 #include "commandlineparser.h"
 #include "languagemanager.h"
 #include "mainwindow.h"
 #include "mapdocument.h"
 #include "mapformat.h"
+#include "mapimageexporter.h"
+#include "mapobject.h"
+#include "maptovariantconverter.h"
 #include "mapreader.h"
+#include "objectgroup.h"
 #include "pluginmanager.h"
 #include "preferences.h"
+#include "properties.h"
+#include "savefile.h"
 #include "sparkleautoupdater.h"
 #include "standardautoupdater.h"
 #include "stylehelper.h"
 #include "tiledapplication.h"
+#include "tile.h"
 #include "tileset.h"
 #include "tmxmapformat.h"
 #include "winsparkleautoupdater.h"
 
 #include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QMutex>
+#include <QProcess>
+#include <QQueue>
+#include <QRegExp>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
 #include <QtPlugin>
 
+#include <functional>
 #include <memory>
 
 #include <QDebug>
@@ -72,6 +92,11 @@ public:
     bool disableOpenGL;
     bool exportMap;
     bool exportTileset;
+    bool exportMapBatch;
+    bool autoMap;
+    bool autoMapBatch;
+    bool reportPropertiesMemory;
+    bool exportImage;
     bool newInstance;
 
 private:
@@ -80,6 +105,11 @@ private:
     void setDisableOpenGL();
     void setExportMap();
     void setExportTileset();
+    void setExportMapBatch();
+    void setAutoMap();
+    void setAutoMapBatch();
+    void setReportPropertiesMemory();
+    void setExportImage();
     void showExportFormats();
     void startNewInstance();
 
@@ -149,6 +179,622 @@ inline T *findExportFormat(const QString *filter,
     return outputFormat;//صʽ(,eg:json)
 }
 
+/**
+ * Keeps track of the maps read by ReadMapTask and exported by ExportMapTask
+ * instances.
+ *
+ * The number of maps in flight is limited by \a capacity, so that loading
+ * can't run arbitrarily far ahead of writing.
+ */
+struct MapExportQueue
+{
+    struct ReadMap
+    {
+        int index;
+        Map *map;
+        MapReader *reader;  // Set when the map still needs loadDeferred()
+        QString error;
+        qint64 loadTime;
+    };
+
+    explicit MapExportQueue(int capacity)
+        : freeSlots(capacity)
+        , failures(0)
+    {}
+
+    void mapRead(const ReadMap &result)
+    {
+        {
+            QMutexLocker locker(&mutex);
+            readMaps.enqueue(result);
+        }
+        readCount.release();
+    }
+
+    /**
+     * Waits until a map has been read and returns it.
+     */
+    ReadMap takeReadMap()
+    {
+        readCount.acquire();
+        QMutexLocker locker(&mutex);
+        return readMaps.dequeue();
+    }
+
+    void finished(Map *map, bool success)
+    {
+        QMutexLocker locker(&mutex);
+        exportedMaps.append(map);
+        if (!success)
+            ++failures;
+        freeSlots.release();
+    }
+
+    /**
+     * Deletes the maps that have been written. Needs to happen on the main
+     * thread, since releasing tilesets touches the TilesetManager.
+     */
+    void deleteExportedMaps()
+    {
+        QVector<Map*> maps;
+        {
+            QMutexLocker locker(&mutex);
+            maps.swap(exportedMaps);
+        }
+        qDeleteAll(maps);
+    }
+
+    QSemaphore freeSlots;
+    QSemaphore readCount;
+    QMutex mutex;
+    QMutex formatMutex;
+    QMutex reportMutex;
+    QQueue<ReadMap> readMaps;
+    QVector<Map*> exportedMaps;
+    int failures;
+};
+
+/**
+ * Reads a TMX map on a worker thread. Loading its external tilesets, object
+ * templates and images is deferred, since these are shared through the
+ * TilesetManager and are loaded on the main thread.
+ */
+class ReadMapTask : public QRunnable
+{
+public:
+    ReadMapTask(int index,
+                const QString &fileName,
+                MapExportQueue *queue)
+        : mIndex(index)
+        , mFileName(fileName)
+        , mQueue(queue)
+    {}
+
+    void run() override
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        MapReader *reader = new MapReader;
+        reader->setDeferLoading(true);
+
+        MapExportQueue::ReadMap result;
+        result.index = mIndex;
+        result.map = reader->readMap(mFileName);
+        result.reader = reader;
+        if (!result.map)
+            result.error = reader->errorString();
+        result.loadTime = timer.elapsed();
+
+        mQueue->mapRead(result);
+    }
+
+private:
+    const int mIndex;
+    const QString mFileName;
+    MapExportQueue *mQueue;
+};
+
+/**
+ * Writes \a map as JSON to \a fileName. Unlike the shared JSON plugin, this
+ * keeps no state, so it can run on any number of threads at once.
+ */
+static bool writeJsonMap(const Map *map, const QString &fileName, QString *error)
+{
+    SaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        *error = QCoreApplication::translate("Command line", "Could not open file for writing.");
+        return false;
+    }
+
+    MapToVariantConverter converter;
+    const QVariant variant = converter.toVariant(*map, QFileInfo(fileName).dir());
+    file.device()->write(QJsonDocument::fromVariant(variant).toJson());
+
+    if (file.error() != QFileDevice::NoError || !file.commit()) {
+        *error = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Writes a map to its target file.
+ *
+ * TMX and JSON are written without going through the shared format instance,
+ * so these maps are written in parallel. Other formats may store their error
+ * string while writing, so their writes are serialized.
+ */
+class ExportMapTask : public QRunnable
+{
+public:
+    ExportMapTask(Map *map,
+                  MapFormat *format,
+                  const QString &targetFile,
+                  qint64 loadTime,
+                  MapExportQueue *queue)
+        : mMap(map)
+        , mFormat(format)
+        , mTargetFile(targetFile)
+        , mLoadTime(loadTime)
+        , mQueue(queue)
+    {}
+
+    void run() override
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        bool success;
+        QString error;
+
+        if (qobject_cast<TmxMapFormat*>(mFormat)) {
+            TmxMapFormat tmxMapFormat;
+            success = tmxMapFormat.write(mMap, mTargetFile);
+            if (!success)
+                error = tmxMapFormat.errorString();
+        } else if (mFormat->shortName() == QLatin1String("json")) {
+            success = writeJsonMap(mMap, mTargetFile, &error);
+        } else {
+            QMutexLocker locker(&mQueue->formatMutex);
+            success = mFormat->write(mMap, mTargetFile);
+            if (!success)
+                error = mFormat->errorString();
+        }
+
+        {
+            QMutexLocker locker(&mQueue->reportMutex);
+            if (success) {
+                qWarning().noquote() << QCoreApplication::translate("Command line", "%1: loaded in %2 ms, written in %3 ms")
+                                        .arg(mTargetFile).arg(mLoadTime).arg(timer.elapsed());
+            } else {
+                qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export map to %1: %2")
+                                        .arg(mTargetFile, error);
+            }
+        }
+
+        mQueue->finished(mMap, success);
+    }
+
+private:
+    Map *mMap;
+    MapFormat *mFormat;
+    const QString mTargetFile;
+    const qint64 mLoadTime;
+    MapExportQueue *mQueue;
+};
+
+/**
+ * Expands directories to the TMX files they contain and wildcard patterns to
+ * the files they match, since not every shell does the latter.
+ */
+QStringList expandSourceFiles(const QStringList &arguments)
+{
+    QStringList files;
+
+    for (const QString &argument : arguments) {
+        const QFileInfo info(argument);
+
+        if (info.isDir()) {
+            const QDir dir(argument);
+            const QStringList nameFilters(QLatin1String("*.tmx"));
+            for (const QString &fileName : dir.entryList(nameFilters, QDir::Files, QDir::Name))
+                files.append(dir.filePath(fileName));
+        } else if (argument.contains(QLatin1Char('*')) || argument.contains(QLatin1Char('?'))) {
+            const QDir dir = info.dir();
+            const QStringList nameFilters(info.fileName());
+            for (const QString &fileName : dir.entryList(nameFilters, QDir::Files, QDir::Name))
+                files.append(dir.filePath(fileName));
+        } else {
+            files.append(argument);
+        }
+    }
+
+    return files;
+}
+
+/**
+ * Checks that no two of the \a sourceFiles are written to the same file in
+ * \a targetFiles, which would make the parallel jobs overwrite each other's
+ * output. Reports each conflict and returns whether there were none.
+ */
+bool checkUniqueTargets(const QStringList &sourceFiles,
+                        const QStringList &targetFiles)
+{
+    QHash<QString, QString> sourceForTarget;
+    bool unique = true;
+
+    for (int i = 0; i < sourceFiles.size(); ++i) {
+        QString key = QDir::cleanPath(QFileInfo(targetFiles.at(i)).absoluteFilePath());
+#if defined(Q_OS_WIN) || defined(Q_OS_MAC)
+        key = key.toLower();
+#endif
+        const auto it = sourceForTarget.constFind(key);
+        if (it != sourceForTarget.constEnd()) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "%1 and %2 would both be written to %3")
+                                    .arg(it.value(), sourceFiles.at(i), targetFiles.at(i));
+            unique = false;
+        } else {
+            sourceForTarget.insert(key, sourceFiles.at(i));
+        }
+    }
+
+    return unique;
+}
+
+/**
+ * Exports all \a sourceFiles into \a targetDirectory using \a outputFormat.
+ *
+ * TMX maps are read in parallel on the global thread pool, but their external
+ * tilesets, templates and images are loaded on the main thread, where the
+ * TilesetManager lives. Each external tileset stays referenced for the whole
+ * batch, so it is only parsed once. Writing happens in parallel as well.
+ *
+ * Returns the number of maps that failed to export.
+ */
+int exportMapBatch(MapFormat *outputFormat,
+                   const QString &targetDirectory,
+                   const QStringList &sourceFiles)
+{
+    const QDir targetDir(targetDirectory);
+    if (!targetDir.mkpath(QLatin1String("."))) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Could not create target directory %1").arg(targetDirectory);
+        return sourceFiles.size();
+    }
+
+    QRegExp extensionFinder(QLatin1String("\\(\\*\\.([^\\)\\s]*)"));
+    extensionFinder.indexIn(outputFormat->nameFilter());
+    QString extension = extensionFinder.cap(1);
+    if (extension.isEmpty())
+        extension = outputFormat->shortName();
+
+    QStringList targetFiles;
+    for (const QString &sourceFile : sourceFiles)
+        targetFiles.append(targetDir.absoluteFilePath(QFileInfo(sourceFile).completeBaseName()
+                                                      + QLatin1Char('.') + extension));
+
+    if (!checkUniqueTargets(sourceFiles, targetFiles))
+        return sourceFiles.size();
+
+    QThreadPool *threadPool = QThreadPool::globalInstance();
+    MapExportQueue queue(threadPool->maxThreadCount() * 2);
+    QHash<Tileset*, SharedTileset> externalTilesets;
+    int failures = 0;
+    int next = 0;
+    int pendingReads = 0;
+
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+
+    while (next < sourceFiles.size() || pendingReads > 0) {
+        // Start reading the next map when there is room for it, or when
+        // there is nothing else to wait for
+        if (next < sourceFiles.size() && (pendingReads == 0 || queue.freeSlots.available() > 0)) {
+            const QString &sourceFile = sourceFiles.at(next);
+
+            queue.freeSlots.acquire();
+            queue.deleteExportedMaps();
+
+            if (qobject_cast<TmxMapFormat*>(findSupportingMapFormat(sourceFile))) {
+                threadPool->start(new ReadMapTask(next, sourceFile, &queue));
+            } else {
+                QElapsedTimer loadTimer;
+                loadTimer.start();
+
+                MapExportQueue::ReadMap result;
+                result.index = next;
+                result.map = readMap(sourceFile, &result.error);
+                result.reader = nullptr;
+                result.loadTime = loadTimer.elapsed();
+                queue.mapRead(result);
+            }
+
+            ++next;
+            ++pendingReads;
+            continue;
+        }
+
+        MapExportQueue::ReadMap read = queue.takeReadMap();
+        const std::unique_ptr<MapReader> reader(read.reader);
+        const QString &sourceFile = sourceFiles.at(read.index);
+        --pendingReads;
+
+        if (!read.map) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load source map %1: %2").arg(sourceFile, read.error);
+            queue.freeSlots.release();
+            ++failures;
+            continue;
+        }
+
+        QElapsedTimer loadTimer;
+        loadTimer.start();
+
+        if (reader)
+            reader->loadDeferred(read.map);
+
+        for (const SharedTileset &tileset : read.map->tilesets())
+            if (tileset->isExternal())
+                externalTilesets.insert(tileset.data(), tileset);
+
+        threadPool->start(new ExportMapTask(read.map, outputFormat, targetFiles.at(read.index),
+                                            read.loadTime + loadTimer.elapsed(), &queue));
+    }
+
+    threadPool->waitForDone();
+    queue.deleteExportedMaps();
+
+    qWarning().noquote() << QCoreApplication::translate("Command line", "Exported %n map(s) in %1 ms.", nullptr, sourceFiles.size() - failures - queue.failures)
+                            .arg(batchTimer.elapsed());
+
+    return failures + queue.failures;
+}
+
+/**
+ * Applies the AutoMapping rules from \a rulesFile to the map \a sourceFile and
+ * writes the result to \a targetFile, in the format matching its extension.
+ *
+ * No MainWindow or MapScene is created, which allows AutoMapping to be used
+ * from content pipelines.
+ */
+bool autoMapFile(const QString &rulesFile,
+                 const QString &sourceFile,
+                 const QString &targetFile)
+{
+    QString errorMsg;
+    MapFormat *outputFormat = findExportFormat<MapFormat>(nullptr, targetFile, errorMsg);
+    if (!outputFormat) {
+        qWarning().noquote() << targetFile << errorMsg;
+        return false;
+    }
+
+    Map *map = readMap(sourceFile, &errorMsg);
+    if (!map) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load source map %1: %2").arg(sourceFile, errorMsg);
+        return false;
+    }
+
+    MapDocumentPtr mapDocument = MapDocumentPtr::create(map, sourceFile);
+
+    AutomappingManager automappingManager;
+    automappingManager.setRulesFileName(rulesFile);
+    automappingManager.setMapDocument(mapDocument.data());
+    automappingManager.autoMap();
+
+    if (!automappingManager.warningString().isEmpty())
+        qWarning().noquote() << automappingManager.warningString();
+
+    if (!automappingManager.errorString().isEmpty()) {
+        qWarning().noquote() << automappingManager.errorString();
+        return false;
+    }
+
+    if (!outputFormat->write(mapDocument->map(), targetFile)) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to write map %1: %2").arg(targetFile, outputFormat->errorString());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * AutoMaps each of the \a sourceFiles into \a targetDirectory, keeping their
+ * file names.
+ *
+ * The maps are split into small chunks, which are handed to child processes
+ * running "--automap" on as many cores as are available. Separate processes
+ * are used because the documents, tileset manager and image cache are not
+ * meant to be shared between threads.
+ *
+ * Returns the number of maps that failed.
+ */
+int autoMapBatch(const QString &rulesFile,
+                 const QString &targetDirectory,
+                 const QStringList &sourceFiles)
+{
+    const QDir targetDir(targetDirectory);
+    if (!targetDir.mkpath(QLatin1String("."))) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Could not create target directory %1").arg(targetDirectory);
+        return sourceFiles.size();
+    }
+
+    QStringList targetFiles;
+    for (const QString &sourceFile : sourceFiles)
+        targetFiles.append(targetDir.absoluteFilePath(QFileInfo(sourceFile).fileName()));
+
+    if (!checkUniqueTargets(sourceFiles, targetFiles))
+        return sourceFiles.size();
+
+    const QString absoluteRulesFile = QFileInfo(rulesFile).absoluteFilePath();
+
+    QVector<QStringList> chunks;
+    const int jobCount = qBound(1, QThread::idealThreadCount(), sourceFiles.size());
+    const int chunkSize = qBound(1, sourceFiles.size() / (jobCount * 4), 32);
+
+    for (int i = 0; i < sourceFiles.size(); ++i) {
+        if (i % chunkSize == 0)
+            chunks.append(QStringList { QLatin1String("--automap"), absoluteRulesFile });
+
+        chunks.last().append(QFileInfo(sourceFiles.at(i)).absoluteFilePath());
+        chunks.last().append(targetFiles.at(i));
+    }
+
+    if (jobCount == 1) {
+        int failures = 0;
+        for (const QStringList &chunk : qAsConst(chunks))
+            for (int i = 2; i < chunk.size(); i += 2)
+                if (!autoMapFile(absoluteRulesFile, chunk.at(i), chunk.at(i + 1)))
+                    ++failures;
+        return failures;
+    }
+
+    QEventLoop eventLoop;
+    int nextChunk = 0;
+    int running = 0;
+    int failures = 0;
+
+    std::function<void()> startNextChunk;
+
+    auto chunkFinished = [&] {
+        --running;
+
+        if (nextChunk < chunks.size())
+            startNextChunk();
+        else if (running == 0)
+            eventLoop.quit();
+    };
+
+    startNextChunk = [&] {
+        const QStringList arguments = chunks.at(nextChunk++);
+        const int mapCount = (arguments.size() - 2) / 2;
+
+        QProcess *process = new QProcess(&eventLoop);
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+
+        QObject::connect(process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                         process, [&, process, mapCount] (int exitCode, QProcess::ExitStatus exitStatus) {
+            // A crashed worker may have lost any of its maps
+            if (exitStatus != QProcess::NormalExit)
+                failures += mapCount;
+            else
+                failures += qMin(exitCode, mapCount);
+
+            process->deleteLater();
+            chunkFinished();
+        });
+
+        ++running;
+        process->start(QCoreApplication::applicationFilePath(), arguments);
+        if (!process->waitForStarted()) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to start AutoMapping worker: %1").arg(process->errorString());
+            failures += mapCount;
+            delete process;
+            chunkFinished();
+        }
+    };
+
+    while (running < jobCount && nextChunk < chunks.size())
+        startNextChunk();
+
+    if (running > 0)
+        eventLoop.exec();
+
+    return failures;
+}
+
+/**
+ * Prints an estimate of the memory used by the custom properties of the map
+ * \a fileName, both as loaded and as it would be without sharing.
+ */
+bool reportPropertiesMemory(const QString &fileName)
+{
+    QString errorMsg;
+    const std::unique_ptr<Map> map(readMap(fileName, &errorMsg));
+    if (!map) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load source map %1: %2").arg(fileName, errorMsg);
+        return false;
+    }
+
+    PropertiesMemoryReport report;
+    report.add(map->properties());
+
+    for (const SharedTileset &tileset : map->tilesets()) {
+        report.add(tileset->properties());
+        for (const Tile *tile : tileset->tiles())
+            report.add(tile->properties());
+    }
+
+    LayerIterator iterator(map.get());
+    while (Layer *layer = iterator.next()) {
+        report.add(layer->properties());
+        if (const ObjectGroup *objectGroup = layer->asObjectGroup())
+            for (const MapObject *mapObject : objectGroup->objects())
+                report.add(mapObject->properties());
+    }
+
+    qWarning().noquote() << QCoreApplication::translate("Command line", "%1: %2 property sets sharing %3 instances, about %4 KiB (%5 KiB unshared)")
+                            .arg(fileName)
+                            .arg(report.propertySetCount())
+                            .arg(report.sharedPropertySetCount())
+                            .arg(report.memoryUsage() / 1024)
+                            .arg(report.unsharedMemoryUsage() / 1024);
+    return true;
+}
+
+/**
+ * Renders the map \a sourceFile to \a target at the given scale. TIFF files
+ * and directories of tiles are written in bands, so the image doesn't need
+ * to fit in memory.
+ */
+bool exportImage(const QString &sourceFile,
+                 const QString &target,
+                 const QString &scaleArgument)
+{
+    qreal scale = 1.0;
+    if (!scaleArgument.isEmpty()) {
+        bool ok;
+        scale = scaleArgument.toDouble(&ok);
+        if (!ok || scale <= 0) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Invalid scale: %1").arg(scaleArgument);
+            return false;
+        }
+    }
+
+    QString errorMsg;
+    const std::unique_ptr<Map> map(readMap(sourceFile, &errorMsg));
+    if (!map) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load source map %1: %2").arg(sourceFile, errorMsg);
+        return false;
+    }
+
+    MiniMapRenderer::RenderFlags renderFlags(MiniMapRenderer::DrawTileLayers |
+                                             MiniMapRenderer::DrawMapObjects |
+                                             MiniMapRenderer::DrawImageLayers |
+                                             MiniMapRenderer::IgnoreInvisibleLayer);
+    if (scale != 1.0 && scale < 2.0)
+        renderFlags |= MiniMapRenderer::SmoothPixmapTransform;
+
+    MapImageExporter exporter(map.get(), renderFlags);
+    const QSize imageSize = exporter.imageSize(scale);
+    const QFileInfo targetInfo(target);
+
+    bool succeeded;
+    if (MapImageExporter::isTiffFile(target))
+        succeeded = exporter.writeTiff(target, imageSize);
+    else if (targetInfo.isDir() || targetInfo.suffix().isEmpty())
+        succeeded = exporter.writeTiles(target, imageSize);
+    else
+        succeeded = exporter.writeImage(target, imageSize);
+
+    if (!succeeded) {
+        qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export image %1: %2").arg(target, exporter.errorString());
+        return false;
+    }
+
+    return true;
+}
+
 
 } // anonymous namespaceֿռ
 
@@ -159,6 +805,11 @@ CommandLineHandler::CommandLineHandler()
     , disableOpenGL(false)
     , exportMap(false)
     , exportTileset(false)
+    , exportMapBatch(false)
+    , autoMap(false)
+    , autoMapBatch(false)
+    , reportPropertiesMemory(false)
+    , exportImage(false)
     , newInstance(false)
 {
     option<&CommandLineHandler::showVersion>(//CommandLineHandler::showVersion
@@ -186,6 +837,31 @@ CommandLineHandler::CommandLineHandler()
                 QLatin1String("--export-tileset"),
                 tr("Export the specified tileset file to target"));
 
+    option<&CommandLineHandler::setExportMapBatch>(
+                QChar(),
+                QLatin1String("--export-map-batch"),
+                tr("Export many maps in parallel: <format> <target-directory> <sources, directories or patterns...>"));
+
+    option<&CommandLineHandler::setAutoMap>(
+                QChar(),
+                QLatin1String("--automap"),
+                tr("Apply AutoMapping rules to maps: <rules> <source> <target> [<source> <target>...]"));
+
+    option<&CommandLineHandler::setAutoMapBatch>(
+                QChar(),
+                QLatin1String("--automap-batch"),
+                tr("Apply AutoMapping rules to many maps in parallel: <rules> <target-directory> <sources...>"));
+
+    option<&CommandLineHandler::setReportPropertiesMemory>(
+                QChar(),
+                QLatin1String("--properties-memory"),
+                tr("Estimate the memory used by the custom properties of the given maps"));
+
+    option<&CommandLineHandler::setExportImage>(
+                QChar(),
+                QLatin1String("--export-image"),
+                tr("Render a map to a large image: <source> <target.tif|target-directory> [<scale>]"));
+
     option<&CommandLineHandler::showExportFormats>(
                 QChar(),
                 QLatin1String("--export-formats"),
@@ -226,6 +902,31 @@ void CommandLineHandler::setExportTileset()
 {
     exportTileset = true;
 }
+
+void CommandLineHandler::setExportMapBatch()
+{
+    exportMapBatch = true;
+}
+
+void CommandLineHandler::setAutoMap()
+{
+    autoMap = true;
+}
+
+void CommandLineHandler::setAutoMapBatch()
+{
+    autoMapBatch = true;
+}
+
+void CommandLineHandler::setReportPropertiesMemory()
+{
+    reportPropertiesMemory = true;
+}
+
+void CommandLineHandler::setExportImage()
+{
+    exportImage = true;
+}
 //ʾֵ֧ĸʽļʽ שmapָʽжƣ
 void CommandLineHandler::showExportFormats()
 {
@@ -281,6 +982,23 @@ int main(int argc, char *argv[])
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)//ʧܴڵİť
     QGuiApplication::setAttribute(Qt::AA_DisableWindowContextHelpButton);
 #endif
+#ifdef Q_OS_LINUX
+    // The command line batch modes should not need a display server
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM") &&
+            qEnvironmentVariableIsEmpty("DISPLAY") &&
+            qEnvironmentVariableIsEmpty("WAYLAND_DISPLAY")) {
+        for (int i = 1; i < argc; ++i) {
+            if (qstrcmp(argv[i], "--automap") == 0 ||
+                    qstrcmp(argv[i], "--automap-batch") == 0 ||
+                    qstrcmp(argv[i], "--export-map-batch") == 0 ||
+                    qstrcmp(argv[i], "--export-image") == 0) {
+                qputenv("QT_QPA_PLATFORM", "offscreen");
+                break;
+            }
+        }
+    }
+#endif
+
     TiledApplication a(argc, argv);
 
     a.setOrganizationDomain(QLatin1String("mapeditor.org"));//Ӧó(ע)
@@ -402,6 +1120,91 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (commandLine.exportMapBatch) {
+        const QStringList &files = commandLine.filesToOpen();
+        if (commandLine.exportMap || commandLine.exportTileset || files.length() < 3) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Batch export syntax is --export-map-batch <format> <target-directory> <sources...>");
+            return 1;
+        }
+
+        PluginManager::instance()->loadPlugins();
+
+        QString errorMsg;
+        MapFormat *outputFormat = findExportFormat<MapFormat>(&files.at(0), QString(), errorMsg);
+        if (!outputFormat) {
+            Q_ASSERT(!errorMsg.isEmpty());
+            qWarning().noquote() << errorMsg;
+            return 1;
+        }
+
+        const QStringList sourceFiles = expandSourceFiles(files.mid(2));
+        return exportMapBatch(outputFormat, files.at(1), sourceFiles) > 0 ? 1 : 0;
+    }
+
+    if (commandLine.autoMap) {
+        const QStringList &files = commandLine.filesToOpen();
+        if (commandLine.exportMap || commandLine.exportTileset || commandLine.autoMapBatch ||
+                files.length() < 3 || files.length() % 2 == 0) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "AutoMap syntax is --automap <rules> <source> <target> [<source> <target>...]");
+            return 1;
+        }
+
+        PluginManager::instance()->loadPlugins();
+
+        int failures = 0;
+        for (int i = 1; i < files.length(); i += 2)
+            if (!autoMapFile(files.at(0), files.at(i), files.at(i + 1)))
+                ++failures;
+
+        return qMin(failures, 255);
+    }
+
+    if (commandLine.autoMapBatch) {
+        const QStringList &files = commandLine.filesToOpen();
+        if (commandLine.exportMap || commandLine.exportTileset || files.length() < 3) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "AutoMap batch syntax is --automap-batch <rules> <target-directory> <sources...>");
+            return 1;
+        }
+
+        PluginManager::instance()->loadPlugins();
+
+        const int failures = autoMapBatch(files.at(0), files.at(1), files.mid(2));
+        if (failures > 0) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "AutoMapping failed for %n map(s).", nullptr, failures);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (commandLine.reportPropertiesMemory) {
+        const QStringList &files = commandLine.filesToOpen();
+        if (files.isEmpty()) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Properties memory syntax is --properties-memory <maps...>");
+            return 1;
+        }
+
+        PluginManager::instance()->loadPlugins();
+
+        int failures = 0;
+        for (const QString &fileName : files)
+            if (!reportPropertiesMemory(fileName))
+                ++failures;
+
+        return qMin(failures, 255);
+    }
+
+    if (commandLine.exportImage) {
+        const QStringList &files = commandLine.filesToOpen();
+        if (files.size() < 2 || files.size() > 3) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Export image syntax is --export-image <source> <target.tif|target-directory> [<scale>]");
+            return 1;
+        }
+
+        PluginManager::instance()->loadPlugins();
+
+        return exportImage(files.at(0), files.at(1), files.value(2)) ? 0 : 1;
+    }
+
     if (!commandLine.filesToOpen().isEmpty() && !commandLine.newInstance) {
         // Convert files to absolute paths because the already running Tiled
         // instance likely does not have the same working directory.
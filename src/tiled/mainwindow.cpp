@@ -1658,6 +1658,8 @@ void MainWindow::documentChanged(Document *document)
     if (document) {
         connect(document, &Document::fileNameChanged,
                 this, &MainWindow::updateWindowTitle);
+        connect(document, &Document::modifiedChanged,
+                this, &MainWindow::updateWindowTitle);
     }
 
     MapDocument *mapDocument = qobject_cast<MapDocument*>(document);
@@ -61,9 +61,14 @@
 #include "tmxmapformat.h"
 
 #include <QFileInfo>
+#include <QHash>
 #include <QRect>
+#include <QSet>
+#include <QSignalBlocker>
 #include <QUndoStack>
 
+#include <algorithm>
+
 #include "qtcompat_p.h"
 
 using namespace Tiled;
@@ -96,7 +101,7 @@ MapDocument::MapDocument(Map *map, const QString &fileName)
     // Forward signals emitted from the map object model
     mMapObjectModel->setMapDocument(this);
     connect(mMapObjectModel, &MapObjectModel::objectsAdded,
-            this, &MapDocument::objectsAdded);
+            this, &MapDocument::onObjectsAdded);
     connect(mMapObjectModel, &MapObjectModel::objectsChanged,
             this, &MapDocument::objectsChanged);
     connect(mMapObjectModel, &MapObjectModel::objectsTypeChanged,
@@ -115,7 +120,13 @@ MapDocument::MapDocument(Map *map, const QString &fileName)
             this, &MapDocument::updateTemplateInstances);
 }
 
-MapDocument::~MapDocument() = default;
+MapDocument::~MapDocument()
+{
+    // Delete the commands while the map still exists, since they report the
+    // memory they release back to this document
+    const QSignalBlocker blocker(mUndoStack);
+    mUndoStack->clear();
+}
 
 bool MapDocument::save(const QString &fileName, QString *error)
 {
@@ -131,7 +142,7 @@ bool MapDocument::save(const QString &fileName, QString *error)
         return false;
     }
 
-    undoStack()->setClean();
+    setClean();
     setFileName(fileName);
     mLastSaved = QFileInfo(fileName).lastModified();//Returns the date and local time when the file was last modified.
 
@@ -753,28 +764,43 @@ void MapDocument::replaceObjectTemplate(const ObjectTemplate *oldObjectTemplate,
 
 void MapDocument::setSelectedArea(const QRegion &selection)
 {
-    if (mSelectedArea != selection) {
+    if (mSelectedArea != selection)
+        setSelectedArea(BitmapRegion(selection));
+}
+
+void MapDocument::setSelectedArea(const BitmapRegion &selection)
+{
+    if (mSelectedCells != selection) {
         const QRegion oldSelectedArea = mSelectedArea;
-        mSelectedArea = selection;
+        mSelectedCells = selection;
+        mSelectedArea = selection.toRegion();
         emit selectedAreaChanged(mSelectedArea, oldSelectedArea);
     }
 }
 
 static QList<MapObject *> sortObjects(const Map &map, const QList<MapObject *> &objects)
 {
-    QList<MapObject *> sorted;
-    sorted.reserve(objects.size());
+    // Determine the order of the object groups
+    QHash<const ObjectGroup*, int> groupOrder;
+    LayerIterator iterator(&map, Layer::ObjectGroupType);
+    while (Layer *layer = iterator.next())
+        groupOrder.insert(static_cast<ObjectGroup*>(layer), groupOrder.size());
+
+    QVector<QPair<QPair<int, int>, MapObject*>> keyed;
+    keyed.reserve(objects.size());
+
+    for (MapObject *mapObject : objects) {
+        const auto it = groupOrder.constFind(mapObject->objectGroup());
+        if (it != groupOrder.constEnd())
+            keyed.append(qMakePair(qMakePair(it.value(), mapObject->index()), mapObject));
+    }
 
-    LayerIterator iterator(&map);
-    while (Layer *layer = iterator.next()) {
-        if (layer->layerType() != Layer::ObjectGroupType)
-            continue;
+    std::sort(keyed.begin(), keyed.end());
 
-        for (MapObject *mapObject : static_cast<ObjectGroup*>(layer)->objects()) {
-            if (objects.contains(mapObject))
-                sorted.append(mapObject);
-        }
-    }
+    QList<MapObject *> sorted;
+    sorted.reserve(keyed.size());
+    for (const auto &pair : qAsConst(keyed))
+        sorted.append(pair.second);
 
     return sorted;
 }
@@ -929,6 +955,12 @@ bool MapDocument::templateAllowed(const ObjectTemplate *objectTemplate) const
     return true;
 }
 
+void MapDocument::onObjectsAdded(const QList<MapObject*> &objects)
+{
+    emitPendingIndexChanges();
+    emit objectsAdded(objects);
+}
+
 /**
  * Before forwarding the signal, the objects are removed from the list of
  * selected objects, triggering a selectedObjectsChanged signal when
@@ -936,6 +968,8 @@ bool MapDocument::templateAllowed(const ObjectTemplate *objectTemplate) const
  */
 void MapDocument::onObjectsRemoved(const QList<MapObject*> &objects)
 {
+    emitPendingIndexChanges();
+
     if (mHoveredMapObject && objects.contains(mHoveredMapObject))
         setHoveredMapObject(nullptr);
 
@@ -965,8 +999,36 @@ void MapDocument::onMapObjectModelRowsInsertedOrRemoved(const QModelIndex &paren
 
     // Inserting or removing objects changes the index of any that come after
     const int lastIndex = objectGroup->objectCount() - 1;
-    if (last < lastIndex)
-        emit objectsIndexChanged(objectGroup, last + 1, lastIndex);
+    if (last >= lastIndex)
+        return;
+
+    // During bulk changes, only report the combined change at the end
+    if (mMapObjectModel->isChangingObjects()) {
+        auto it = mPendingIndexChanges.find(objectGroup);
+        if (it == mPendingIndexChanges.end())
+            mPendingIndexChanges.insert(objectGroup, last + 1);
+        else
+            *it = qMin(*it, last + 1);
+        return;
+    }
+
+    emit objectsIndexChanged(objectGroup, last + 1, lastIndex);
+}
+
+/**
+ * Emits objectsIndexChanged for the ranges collected while the map object
+ * model was adding or removing objects in bulk.
+ */
+void MapDocument::emitPendingIndexChanges()
+{
+    const auto pending = mPendingIndexChanges;
+    mPendingIndexChanges.clear();
+
+    for (auto it = pending.begin(), it_end = pending.end(); it != it_end; ++it) {
+        const int lastIndex = it.key()->objectCount() - 1;
+        if (it.value() <= lastIndex)
+            emit objectsIndexChanged(it.key(), it.value(), lastIndex);
+    }
 }
 
 void MapDocument::onObjectsMoved(const QModelIndex &parent, int start, int end,
@@ -1071,9 +1133,19 @@ void MapDocument::deselectObjects(const QList<MapObject *> &objects)
         if (objects.contains(static_cast<MapObject*>(mCurrentObject)))
             setCurrentObject(nullptr);
 
+    if (mSelectedObjects.isEmpty())
+        return;
+
     int removedCount = 0;
-    for (MapObject *object : objects)
-        removedCount += mSelectedObjects.removeAll(object);
+    if (objects.size() == 1) {
+        removedCount = mSelectedObjects.removeAll(objects.first());
+    } else {
+        const QSet<MapObject*> objectSet = objects.toSet();
+        const auto it = std::remove_if(mSelectedObjects.begin(), mSelectedObjects.end(),
+                                       [&] (MapObject *object) { return objectSet.contains(object); });
+        removedCount = mSelectedObjects.end() - it;
+        mSelectedObjects.erase(it, mSelectedObjects.end());
+    }
 
     if (removedCount > 0)
         emit selectedObjectsChanged();
@@ -1084,19 +1156,22 @@ void MapDocument::duplicateObjects(const QList<MapObject *> &objects)
     if (objects.isEmpty())
         return;
 
-    mUndoStack->beginMacro(tr("Duplicate %n Object(s)", "", objects.size()));
-
     QList<MapObject*> clones;
+    QVector<MapObjectModel::ObjectEntry> entries;
+    clones.reserve(objects.size());
+    entries.reserve(objects.size());
+
     for (const MapObject *mapObject : objects) {
         MapObject *clone = mapObject->clone();
         clone->resetId();
         clones.append(clone);
-        mUndoStack->push(new AddMapObject(this,
-                                          mapObject->objectGroup(),
-                                          clone));
+        entries.append(MapObjectModel::ObjectEntry { mapObject->objectGroup(), -1, clone });
     }
 
-    mUndoStack->endMacro();
+    auto command = new AddMapObjects(this, entries);
+    command->setText(tr("Duplicate %n Object(s)", "", objects.size()));
+    mUndoStack->push(command);
+
     setSelectedObjects(clones);
 }
 
@@ -1105,11 +1180,8 @@ void MapDocument::removeObjects(const QList<MapObject *> &objects)
     if (objects.isEmpty())
         return;
 
-    mUndoStack->beginMacro(tr("Remove %n Object(s)", "", objects.size()));
     const auto objectsCopy = objects;   // original list may get modified
-    for (MapObject *mapObject : objectsCopy)
-        mUndoStack->push(new RemoveMapObject(this, mapObject));
-    mUndoStack->endMacro();
+    mUndoStack->push(new RemoveMapObjects(this, objectsCopy));
 }
 
 void MapDocument::moveObjectsToGroup(const QList<MapObject *> &objects,
@@ -1143,7 +1215,7 @@ static Ranges computeRanges(const QList<MapObject *> &objects)
     for (MapObject *object : objects) {
         ObjectGroup *group = object->objectGroup();
         auto &set = ranges[group];
-        set.insert(group->objects().indexOf(object));
+        set.insert(object->index());
     }
 
     return ranges;
@@ -1231,6 +1303,9 @@ void MapDocument::detachObjects(const QList<MapObject *> &objects)
 //Ⱦ
 void MapDocument::createRenderer()
 {
+    // Keep the flags when the renderer is replaced due to an orientation change
+    const RenderFlags flags = mRenderer ? mRenderer->flags() : RenderFlags();
+
     switch (mMap->orientation()) {//mMapͨMapDocumentPtr::create()ݹ
     case Map::Isometric:
         mRenderer.reset(new IsometricRenderer(mMap.get()));//http://www.cplusplus.com/reference/memory/unique_ptr/get/
@@ -1246,4 +1321,6 @@ void MapDocument::createRenderer()
         mRenderer.reset(new OrthogonalRenderer(mMap.get()));
         break;
     }
+
+    mRenderer->setFlags(flags);
 }
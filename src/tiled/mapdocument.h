@@ -22,12 +22,14 @@
 
 #pragma once
 
+#include "bitmapregion.h"
 #include "document.h"
 #include "layer.h"
 #include "mapformat.h"
 #include "tiled.h"
 #include "tileset.h"
 
+#include <QHash>
 #include <QList>
 #include <QPointer>
 #include <QRegion>
@@ -205,10 +207,18 @@ public:
      */
     const QRegion &selectedArea() const { return mSelectedArea; }
 
+    /**
+     * Returns the selected area of tiles as a bitmap region, which is
+     * faster for checking whether a tile is selected and for combining it
+     * with other selections.
+     */
+    const BitmapRegion &selectedCells() const { return mSelectedCells; }
+
     /**
      * Sets the selected area of tiles.
      */
     void setSelectedArea(const QRegion &selection);
+    void setSelectedArea(const BitmapRegion &selection);
 
     /**
      * Returns the list of selected objects.
@@ -331,6 +341,7 @@ signals:
     void tileImageSourceChanged(Tile *tile);
 
 private slots:
+    void onObjectsAdded(const QList<MapObject*> &objects);
     void onObjectsRemoved(const QList<MapObject*> &objects);
 
     void onMapObjectModelRowsInserted(const QModelIndex &parent, int first, int last);
@@ -349,6 +360,7 @@ public slots:
 private:
     void deselectObjects(const QList<MapObject*> &objects);
     void moveObjectIndex(const MapObject *object, int count);
+    void emitPendingIndexChanges();
 
     /*ʹQPointerΪõĸʽɲ̬ӣҲٴɾ
      * QPointer is used since the formats referenced here may be dynamically added by a plugin, and can also be removed again.
@@ -359,12 +371,14 @@ private:
     std::unique_ptr<Map> mMap;
     LayerModel *mLayerModel;
     QRegion mSelectedArea;
+    BitmapRegion mSelectedCells;
     QList<Layer*> mSelectedLayers;
     QList<MapObject*> mSelectedObjects;
     MapObject *mHoveredMapObject;       /**< Map object with mouse on top. */
     std::unique_ptr<MapRenderer> mRenderer;
     Layer *mCurrentLayer;
     MapObjectModel *mMapObjectModel;
+    QHash<ObjectGroup*, int> mPendingIndexChanges;  /**< First changed index per group during bulk changes. */
     bool mAllowHidingObjects = true;
     bool mAllowTileObjects = true;
 };
@@ -338,8 +338,9 @@ void MapDocumentActionHandler::delete_()
         commands.append(new EraseTiles(mMapDocument, tileLayer, area));
     }
 
-    for (MapObject *mapObject : mMapDocument->selectedObjects())
-        commands.append(new RemoveMapObject(mMapDocument, mapObject));
+    const QList<MapObject*> &selectedObjects = mMapDocument->selectedObjects();
+    if (!selectedObjects.isEmpty())
+        commands.append(new RemoveMapObjects(mMapDocument, selectedObjects));
 
     QUndoStack *undoStack = mMapDocument->undoStack();
 
@@ -412,7 +413,8 @@ void MapDocumentActionHandler::selectInverse()//Inverse
         if (mMapDocument->map()->infinite())
             all = tileLayer->bounds();
 
-        QUndoCommand *command = new ChangeSelectedArea(mMapDocument, all - mMapDocument->selectedArea());
+        const BitmapRegion inverse = BitmapRegion(all) - mMapDocument->selectedCells();
+        QUndoCommand *command = new ChangeSelectedArea(mMapDocument, inverse);
         mMapDocument->undoStack()->push(command);
     } else if (ObjectGroup *objectGroup = layer->asObjectGroup()) {
         const auto &allObjects = objectGroup->objects();
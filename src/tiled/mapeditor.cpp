@@ -396,7 +396,7 @@ void MapEditor::setCurrentDocument(Document *document)
     }
 
     mPropertiesDock->setDocument(mapDocument);
-    mUndoDock->setStack(document ? document->undoStack() : nullptr);
+    mUndoDock->setDocument(document);
     mObjectsDock->setMapDocument(mapDocument);
     mTilesetDock->setMapDocument(mapDocument);
     mTerrainDock->setDocument(mapDocument);
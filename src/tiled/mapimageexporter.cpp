@@ -0,0 +1,341 @@
+/*
+ * mapimageexporter.cpp
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapimageexporter.h"
+
+#include "savefile.h"
+
+#include <QAtomicInt>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QVector>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+namespace {
+
+// Rough amount of memory used by a single band while exporting TIFF files
+const qint64 BAND_MEMORY = 32 * 1024 * 1024;
+
+enum TiffType {
+    TiffShort = 3,
+    TiffLong = 4
+};
+
+struct TiffEntry
+{
+    quint16 tag;
+    quint16 type;
+    quint32 count;
+    quint32 value;
+};
+
+/**
+ * Encodes a single tile, allowing the tiles of a band to be compressed in
+ * parallel while the next band is rendered.
+ */
+class TileWriter : public QRunnable
+{
+public:
+    TileWriter(const QImage &tile, const QString &fileName, QAtomicInt *failures)
+        : mTile(tile)
+        , mFileName(fileName)
+        , mFailures(failures)
+    {}
+
+    void run() override
+    {
+        if (!mTile.save(mFileName, "PNG"))
+            mFailures->fetchAndAddRelaxed(1);
+    }
+
+private:
+    const QImage mTile;
+    const QString mFileName;
+    QAtomicInt *mFailures;
+};
+
+QSize halvedSize(QSize size)
+{
+    return QSize(qMax(1, (size.width() + 1) / 2),
+                 qMax(1, (size.height() + 1) / 2));
+}
+
+} // anonymous namespace
+
+MapImageExporter::MapImageExporter(Map *map,
+                                   MiniMapRenderer::RenderFlags renderFlags)
+    : mRenderer(map)
+    , mRenderFlags(renderFlags)
+{
+}
+
+/**
+ * Returns the size of the image when exporting the map at the given \a scale.
+ */
+QSize MapImageExporter::imageSize(qreal scale) const
+{
+    return mRenderer.mapSize() * scale;
+}
+
+/**
+ * Renders the whole image at once and saves it to \a fileName, in the format
+ * matching its extension. Only suitable for images that fit in memory.
+ */
+bool MapImageExporter::writeImage(const QString &fileName, QSize imageSize)
+{
+    QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull()) {
+        mError = tr("Could not allocate sufficient memory for the image. "
+                    "Try exporting to a TIFF file or a directory instead.");
+        return false;
+    }
+
+    mRenderer.renderToImage(image, mRenderFlags);
+
+    if (!image.save(fileName)) {
+        mError = tr("Could not write %1.").arg(fileName);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Writes the image to an uncompressed TIFF file with one strip per band.
+ *
+ * Classic TIFF files use 32-bit offsets, so the image data is limited to
+ * 4 GB. Larger images can still be written as tiles.
+ */
+bool MapImageExporter::writeTiff(const QString &fileName, QSize imageSize)
+{
+    if (imageSize.isEmpty()) {
+        mError = tr("The image would be empty.");
+        return false;
+    }
+
+    const qint64 bytesPerRow = qint64(imageSize.width()) * 4;
+    const int rowsPerStrip = int(qBound<qint64>(1, BAND_MEMORY / bytesPerRow, imageSize.height()));
+    const int stripCount = (imageSize.height() + rowsPerStrip - 1) / rowsPerStrip;
+
+    // Leave room for the header, the directory and the strip tables
+    const qint64 fileSize = bytesPerRow * imageSize.height() + 1024 + qint64(stripCount) * 8;
+    if (fileSize > qint64(0xFFFFFFFFu)) {
+        mError = tr("The image would be %1 x %2 pixels, which is too large for a TIFF file. "
+                    "Try exporting it as tiles to a directory instead.")
+                .arg(imageSize.width())
+                .arg(imageSize.height());
+        return false;
+    }
+
+    QImage band(imageSize.width(), rowsPerStrip, QImage::Format_ARGB32_Premultiplied);
+    if (band.isNull()) {
+        mError = tr("Could not allocate sufficient memory for the image.");
+        return false;
+    }
+
+    SaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        mError = tr("Could not open file for writing.");
+        return false;
+    }
+
+    QFileDevice *device = file.device();
+    QDataStream stream(device);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    // The offset of the image file directory is filled in at the end
+    stream.writeRawData("II", 2);
+    stream << quint16(42) << quint32(0);
+
+    QVector<quint32> stripOffsets;
+    QVector<quint32> stripByteCounts;
+
+    for (int y = 0; y < imageSize.height(); y += rowsPerStrip) {
+        mRenderer.renderToImage(band, mRenderFlags, imageSize, QPoint(0, y));
+
+        // TIFF stores the components in RGBA order
+        const QImage strip = band.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+        const int rows = qMin(rowsPerStrip, imageSize.height() - y);
+
+        stripOffsets.append(quint32(device->pos()));
+        stripByteCounts.append(quint32(bytesPerRow * rows));
+
+        for (int row = 0; row < rows; ++row)
+            stream.writeRawData(reinterpret_cast<const char*>(strip.constScanLine(row)),
+                                int(bytesPerRow));
+    }
+
+    const quint32 bitsPerSampleOffset = quint32(device->pos());
+    stream << quint16(8) << quint16(8) << quint16(8) << quint16(8);
+
+    // A single strip has its offset and size stored in the directory
+    quint32 stripOffsetsValue = stripOffsets.first();
+    quint32 stripByteCountsValue = stripByteCounts.first();
+
+    if (stripCount > 1) {
+        stripOffsetsValue = quint32(device->pos());
+        for (quint32 offset : qAsConst(stripOffsets))
+            stream << offset;
+
+        stripByteCountsValue = quint32(device->pos());
+        for (quint32 byteCount : qAsConst(stripByteCounts))
+            stream << byteCount;
+    }
+
+    const TiffEntry entries[] = {
+        { 256, TiffLong,  1, quint32(imageSize.width()) },      // ImageWidth
+        { 257, TiffLong,  1, quint32(imageSize.height()) },     // ImageLength
+        { 258, TiffShort, 4, bitsPerSampleOffset },             // BitsPerSample
+        { 259, TiffShort, 1, 1 },                               // Compression: none
+        { 262, TiffShort, 1, 2 },                               // PhotometricInterpretation: RGB
+        { 273, TiffLong,  quint32(stripCount), stripOffsetsValue },
+        { 277, TiffShort, 1, 4 },                               // SamplesPerPixel
+        { 278, TiffLong,  1, quint32(rowsPerStrip) },           // RowsPerStrip
+        { 279, TiffLong,  quint32(stripCount), stripByteCountsValue },
+        { 284, TiffShort, 1, 1 },                               // PlanarConfiguration: chunky
+        { 338, TiffShort, 1, 1 },                               // ExtraSamples: premultiplied alpha
+    };
+
+    const quint32 directoryOffset = quint32(device->pos());
+    stream << quint16(sizeof(entries) / sizeof(entries[0]));
+
+    for (const TiffEntry &entry : entries) {
+        stream << entry.tag << entry.type << entry.count;
+
+        // Values that fit are stored in the entry, left-justified
+        if (entry.type == TiffShort && entry.count == 1)
+            stream << quint16(entry.value) << quint16(0);
+        else
+            stream << entry.value;
+    }
+
+    stream << quint32(0);   // No further directories
+
+    device->seek(4);
+    stream << directoryOffset;
+
+    if (stream.status() != QDataStream::Ok) {
+        mError = file.errorString();
+        return false;
+    }
+
+    if (!file.commit()) {
+        mError = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Writes the image as a pyramid of PNG tiles to \a directory.
+ *
+ * The tiles are stored as "<level>/<column>_<row>.png". The highest level
+ * has the full \a imageSize, and each level below it is half the size of
+ * the one above. Level 0 fits in a single tile.
+ */
+bool MapImageExporter::writeTiles(const QString &directory, QSize imageSize, int tileSize)
+{
+    if (imageSize.isEmpty() || tileSize <= 0) {
+        mError = tr("The image would be empty.");
+        return false;
+    }
+
+    int maxLevel = 0;
+    for (QSize size = imageSize; qMax(size.width(), size.height()) > tileSize; size = halvedSize(size))
+        ++maxLevel;
+
+    const QDir dir(directory);
+    QSize levelSize = imageSize;
+
+    for (int level = maxLevel; level >= 0; --level) {
+        if (!writeTileLevel(dir.filePath(QString::number(level)), levelSize, tileSize))
+            return false;
+
+        levelSize = halvedSize(levelSize);
+    }
+
+    return true;
+}
+
+/**
+ * Renders one band per row of tiles. The tiles of a band are encoded on a
+ * thread pool while the next band is rendered, which keeps at most two bands
+ * in memory.
+ */
+bool MapImageExporter::writeTileLevel(const QString &directory, QSize levelSize, int tileSize)
+{
+    const QDir dir(directory);
+    if (!dir.mkpath(QLatin1String("."))) {
+        mError = tr("Could not create directory %1.").arg(directory);
+        return false;
+    }
+
+    QImage band(levelSize.width(), tileSize, QImage::Format_ARGB32_Premultiplied);
+    if (band.isNull()) {
+        mError = tr("Could not allocate sufficient memory for the image.");
+        return false;
+    }
+
+    QThreadPool threadPool;
+    QAtomicInt failures;
+
+    for (int y = 0, row = 0; y < levelSize.height(); y += tileSize, ++row) {
+        mRenderer.renderToImage(band, mRenderFlags, levelSize, QPoint(0, y));
+
+        // Don't queue more tiles before the previous band has been written
+        threadPool.waitForDone();
+
+        const int height = qMin(tileSize, levelSize.height() - y);
+
+        for (int x = 0, column = 0; x < levelSize.width(); x += tileSize, ++column) {
+            const int width = qMin(tileSize, levelSize.width() - x);
+            const QString fileName = dir.filePath(QStringLiteral("%1_%2.png").arg(column).arg(row));
+
+            threadPool.start(new TileWriter(band.copy(x, 0, width, height),
+                                            fileName, &failures));
+        }
+    }
+
+    threadPool.waitForDone();
+
+    if (failures.load() > 0) {
+        mError = tr("Could not write %n tile(s) to %1.", nullptr, failures.load()).arg(directory);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Returns whether \a fileName refers to a TIFF file, which is written in
+ * bands by writeTiff().
+ */
+bool MapImageExporter::isTiffFile(const QString &fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix();
+    return suffix.compare(QLatin1String("tif"), Qt::CaseInsensitive) == 0 ||
+            suffix.compare(QLatin1String("tiff"), Qt::CaseInsensitive) == 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * mapimageexporter.h
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "minimaprenderer.h"
+
+#include <QCoreApplication>
+#include <QSize>
+#include <QString>
+
+namespace Tiled {
+
+class Map;
+
+namespace Internal {
+
+/**
+ * Exports a map as an image that may be too large to keep in memory.
+ *
+ * The image is rendered in horizontal bands, which are either written to an
+ * uncompressed TIFF file or split into a pyramid of PNG tiles. This way the
+ * memory used only depends on the width of the image.
+ *
+ * The bands themselves are rendered one after the other on the calling
+ * thread, since tile images are pixmaps which can't be used on other threads.
+ */
+class MapImageExporter
+{
+    Q_DECLARE_TR_FUNCTIONS(MapImageExporter)
+
+public:
+    MapImageExporter(Map *map, MiniMapRenderer::RenderFlags renderFlags);
+
+    QSize imageSize(qreal scale) const;
+
+    bool writeImage(const QString &fileName, QSize imageSize);
+    bool writeTiff(const QString &fileName, QSize imageSize);
+    bool writeTiles(const QString &directory, QSize imageSize, int tileSize = 256);
+
+    QString errorString() const;
+
+    static bool isTiffFile(const QString &fileName);
+
+private:
+    bool writeTileLevel(const QString &directory, QSize levelSize, int tileSize);
+
+    MiniMapRenderer mRenderer;
+    MiniMapRenderer::RenderFlags mRenderFlags;
+    QString mError;
+};
+
+inline QString MapImageExporter::errorString() const
+{
+    return mError;
+}
+
+} // namespace Internal
+} // namespace Tiled
@@ -25,7 +25,6 @@
 #include "grouplayeritem.h"
 #include "imagelayeritem.h"
 #include "mapobject.h"
-#include "mapobjectitem.h"
 #include "maprenderer.h"
 #include "mapview.h"
 #include "objectgroupitem.h"
@@ -66,6 +65,7 @@ MapItem::MapItem(const MapDocumentPtr &mapDocument, DisplayMode displayMode,
     MapRenderer *renderer = mapDocument->renderer();
     renderer->setObjectLineWidth(prefs->objectLineWidth());
     renderer->setFlag(ShowTileObjectOutlines, prefs->showTileObjectOutlines());
+    renderer->setFlag(LoadImagesInBackground);
 
     connect(prefs, &Preferences::objectLineWidthChanged, this, &MapItem::setObjectLineWidth);
     connect(prefs, &Preferences::showTileObjectOutlinesChanged, this, &MapItem::setShowTileObjectOutlines);
@@ -210,8 +210,7 @@ void MapItem::mapChanged()
             tli->syncWithTileLayer();
     }
 
-    for (MapObjectItem *item : mObjectItems)
-        item->syncWithMapObject();
+    syncAllObjectItems();
 
     updateBoundingRect();
 }
@@ -239,11 +238,7 @@ void MapItem::layerRemoved(Layer *layer)
     switch (layer->layerType()) {
     case Layer::TileLayerType:
     case Layer::ImageLayerType:
-        break;
     case Layer::ObjectGroupType:
-        // Delete any object items
-        for (auto object : static_cast<ObjectGroup*>(layer)->objects())
-            delete mObjectItems.take(object);
         break;
     case Layer::GroupLayerType:
         // Recurse into group layers
@@ -320,8 +315,8 @@ void MapItem::layerChanged(Layer *layer)
  */
 void MapItem::objectGroupChanged(ObjectGroup *objectGroup)
 {
-    objectsChanged(objectGroup->objects());
-    objectsIndexChanged(objectGroup, 0, objectGroup->objectCount() - 1);
+    if (ObjectGroupItem *item = objectGroupItem(objectGroup))
+        item->syncWithObjects();
 }
 
 /**
@@ -345,11 +340,13 @@ void MapItem::adaptToTilesetTileSizeChanges(Tileset *tileset)
         if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
             tli->syncWithTileLayer();
 
-    for (MapObjectItem *item : mObjectItems) {
-        const Cell &cell = item->mapObject()->cell();
-        if (cell.tileset() == tileset)
-            item->syncWithMapObject();
-    }
+    QList<MapObject*> objects;
+    for (Layer *layer : mapDocument()->map()->objectGroups())
+        for (MapObject *object : static_cast<ObjectGroup*>(layer)->objects())
+            if (object->cell().tileset() == tileset)
+                objects.append(object);
+
+    objectsChanged(objects);
 }
 
 void MapItem::adaptToTileSizeChanges(Tile *tile)
@@ -358,11 +355,13 @@ void MapItem::adaptToTileSizeChanges(Tile *tile)
         if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
             tli->syncWithTileLayer();
 
-    for (MapObjectItem *item : mObjectItems) {
-        const Cell &cell = item->mapObject()->cell();
-        if (cell.tile() == tile)
-            item->syncWithMapObject();
-    }
+    QList<MapObject*> objects;
+    for (Layer *layer : mapDocument()->map()->objectGroups())
+        for (MapObject *object : static_cast<ObjectGroup*>(layer)->objects())
+            if (object->cell().tile() == tile)
+                objects.append(object);
+
+    objectsChanged(objects);
 }
 
 void MapItem::tilesetReplaced(int index, Tileset *tileset)
@@ -372,68 +371,43 @@ void MapItem::tilesetReplaced(int index, Tileset *tileset)
 }
 
 /**
- * Inserts map object items for the given objects.
+ * Makes the object group item aware of the given new objects.
  */
 void MapItem::objectsInserted(ObjectGroup *objectGroup, int first, int last)
 {
-    ObjectGroupItem *ogItem = nullptr;
-
-    // Find the object group item for the object group
-    for (QGraphicsItem *item : mLayerItems) {
-        if (ObjectGroupItem *ogi = dynamic_cast<ObjectGroupItem*>(item)) {
-            if (ogi->objectGroup() == objectGroup) {
-                ogItem = ogi;
-                break;
-            }
-        }
-    }
-
+    ObjectGroupItem *ogItem = objectGroupItem(objectGroup);
     Q_ASSERT(ogItem);
 
-    const ObjectGroup::DrawOrder drawOrder = objectGroup->drawOrder();
-
-    for (int i = first; i <= last; ++i) {
-        MapObject *object = objectGroup->objectAt(i);
-
-        MapObjectItem *item = new MapObjectItem(object, mapDocument(), ogItem);
-        if (drawOrder == ObjectGroup::TopDownOrder)
-            item->setZValue(item->y());
-        else
-            item->setZValue(i);
-
-        mObjectItems.insert(object, item);
-    }
+    ogItem->syncWithObjects(objectGroup->objects().mid(first, last - first + 1));
 }
 
 /**
- * Removes the map object items related to the given objects.
+ * Removes the given objects from the object group items.
  */
 void MapItem::objectsRemoved(const QList<MapObject*> &objects)
 {
-    for (MapObject *o : objects) {
-        auto i = mObjectItems.find(o);
-        Q_ASSERT(i != mObjectItems.end());
-
-        delete i.value();
-        mObjectItems.erase(i);
-    }
+    // The objects are no longer part of their object group at this point
+    for (LayerItem *item : qAsConst(mLayerItems))
+        if (ObjectGroupItem *ogItem = dynamic_cast<ObjectGroupItem*>(item))
+            ogItem->removeObjects(objects);
 }
 
 /**
- * Updates the map object items related to the given objects.
+ * Updates the drawing of the given objects.
  */
 void MapItem::objectsChanged(const QList<MapObject*> &objects)
 {
-    for (MapObject *object : objects) {
-        MapObjectItem *item = mObjectItems.value(object);
-        Q_ASSERT(item);
+    QHash<ObjectGroup*, QList<MapObject*>> objectsPerGroup;
+    for (MapObject *object : objects)
+        objectsPerGroup[object->objectGroup()].append(object);
 
-        item->syncWithMapObject();
-    }
+    for (auto it = objectsPerGroup.constBegin(); it != objectsPerGroup.constEnd(); ++it)
+        if (ObjectGroupItem *ogItem = objectGroupItem(it.key()))
+            ogItem->syncWithObjects(it.value());
 }
 
 /**
- * Updates the Z value of the objects when appropriate.
+ * Repaints the objects when their drawing order has changed.
  */
 void MapItem::objectsIndexChanged(ObjectGroup *objectGroup,
                                    int first, int last)
@@ -441,18 +415,17 @@ void MapItem::objectsIndexChanged(ObjectGroup *objectGroup,
     if (objectGroup->drawOrder() != ObjectGroup::IndexOrder)
         return;
 
-    for (int i = first; i <= last; ++i) {
-        MapObjectItem *item = mObjectItems.value(objectGroup->objectAt(i));
-        Q_ASSERT(item);
+    ObjectGroupItem *ogItem = objectGroupItem(objectGroup);
+    Q_ASSERT(ogItem);
 
-        item->setZValue(i);
-    }
+    ogItem->syncWithObjects(objectGroup->objects().mid(first, last - first + 1));
 }
 //ͬеĶitem
 void MapItem::syncAllObjectItems()
 {
-    for (MapObjectItem *item : mObjectItems)
-        item->syncWithMapObject();
+    for (LayerItem *item : qAsConst(mLayerItems))
+        if (ObjectGroupItem *ogItem = dynamic_cast<ObjectGroupItem*>(item))
+            ogItem->syncWithObjects();
 }
 
 
@@ -460,23 +433,15 @@ void MapItem::setObjectLineWidth(qreal lineWidth)
 {
     mapDocument()->renderer()->setObjectLineWidth(lineWidth);
 
-    // Changing the line width can change the size of the object items
-    for (MapObjectItem *item : mObjectItems) {
-        if (item->mapObject()->cell().isEmpty()) {
-            item->syncWithMapObject();
-            item->update();
-        }
-    }
+    // Changing the line width can change the size of the objects
+    syncAllObjectItems();
 }
 
 void MapItem::setShowTileObjectOutlines(bool enabled)
 {
     mapDocument()->renderer()->setFlag(ShowTileObjectOutlines, enabled);
 
-    for (MapObjectItem *item : mObjectItems) {
-        if (!item->mapObject()->cell().isEmpty())
-            item->update();
-    }
+    syncAllObjectItems();
 }
 
 void MapItem::createLayerItems(const QList<Layer *> &layers)
@@ -503,25 +468,9 @@ LayerItem *MapItem::createLayerItem(Layer *layer)
         layerItem = new TileLayerItem(static_cast<TileLayer*>(layer), mapDocument(), parent);
         break;
 
-    case Layer::ObjectGroupType: {
-        auto og = static_cast<ObjectGroup*>(layer);
-        const ObjectGroup::DrawOrder drawOrder = og->drawOrder();
-        ObjectGroupItem *ogItem = new ObjectGroupItem(og, parent);
-        int objectIndex = 0;
-        for (MapObject *object : og->objects()) {
-            MapObjectItem *item = new MapObjectItem(object, mapDocument(),
-                                                    ogItem);
-            if (drawOrder == ObjectGroup::TopDownOrder)
-                item->setZValue(item->y());
-            else
-                item->setZValue(objectIndex);
-
-            mObjectItems.insert(object, item);
-            ++objectIndex;
-        }
-        layerItem = ogItem;
+    case Layer::ObjectGroupType:
+        layerItem = new ObjectGroupItem(static_cast<ObjectGroup*>(layer), mapDocument(), parent);
         break;
-    }
 
     case Layer::ImageLayerType:
         layerItem = new ImageLayerItem(static_cast<ImageLayer*>(layer), mapDocument(), parent);
@@ -545,6 +494,11 @@ LayerItem *MapItem::createLayerItem(Layer *layer)
     return layerItem;
 }
 
+ObjectGroupItem *MapItem::objectGroupItem(ObjectGroup *objectGroup) const
+{
+    return static_cast<ObjectGroupItem*>(mLayerItems.value(objectGroup));
+}
+
 void MapItem::updateBoundingRect()
 {
     QRectF boundingRect = mapDocument()->renderer()->mapBoundingRect();
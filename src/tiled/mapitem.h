@@ -40,7 +40,7 @@ class Tileset;
 namespace Internal {
 
 class LayerItem;
-class MapObjectItem;
+class ObjectGroupItem;
 class ObjectSelectionItem;
 class TileSelectionItem;
 
@@ -114,6 +114,7 @@ private:
 
     void createLayerItems(const QList<Layer *> &layers);
     LayerItem *createLayerItem(Layer *layer);
+    ObjectGroupItem *objectGroupItem(ObjectGroup *objectGroup) const;
 
     void updateBoundingRect();
     void updateCurrentLayerHighlight();
@@ -123,7 +124,6 @@ private:
     std::unique_ptr<TileSelectionItem> mTileSelectionItem;
     std::unique_ptr<ObjectSelectionItem> mObjectSelectionItem;
     QMap<Layer*, LayerItem*> mLayerItems;
-    QMap<MapObject*, MapObjectItem*> mObjectItems;
     DisplayMode mDisplayMode;
     QRectF mBoundingRect;
 };
@@ -179,10 +179,8 @@ QColor MapObjectItem::objectColor(const MapObject *object)
     const QString effectiveType = object->effectiveType();
 
     // See if this object type has a color associated with it
-    for (const ObjectType &type : Object::objectTypes()) {
-        if (type.name.compare(effectiveType, Qt::CaseInsensitive) == 0)
-            return type.color;
-    }
+    if (const ObjectType *type = Object::objectType(effectiveType, Qt::CaseInsensitive))
+        return type->color;
 
     // If not, get color from object group
     const ObjectGroup *objectGroup = object->objectGroup();
@@ -34,6 +34,9 @@
 #include <QPalette>
 #include <QStyle>
 
+#include <algorithm>
+#include <functional>
+
 using namespace Tiled;
 using namespace Tiled::Internal;
 
@@ -41,7 +44,8 @@ MapObjectModel::MapObjectModel(QObject *parent):
     QAbstractItemModel(parent),
     mMapDocument(nullptr),
     mMap(nullptr),
-    mObjectGroupIcon(QLatin1String(":/images/16x16/layer-object.png"))
+    mObjectGroupIcon(QLatin1String(":/images/16x16/layer-object.png")),
+    mChangingObjects(false)
 {
     mObjectGroupIcon.addFile(QLatin1String(":images/32x32/layer-object.png"));
 }
@@ -278,7 +282,7 @@ QModelIndex MapObjectModel::index(Layer *layer) const
 
 QModelIndex MapObjectModel::index(MapObject *mapObject, int column) const
 {
-    const int row = mapObject->objectGroup()->objects().indexOf(mapObject);
+    const int row = mapObject->index();
     return createIndex(row, column, mapObject);
 }
 
@@ -488,7 +492,7 @@ int MapObjectModel::removeObject(ObjectGroup *og, MapObject *o)
     QList<MapObject*> objects;
     objects << o;
 
-    const int row = og->objects().indexOf(o);
+    const int row = og->objectIndex(o);
     beginRemoveRows(index(og), row, row);
     og->removeObjectAt(row);
     endRemoveRows();
@@ -496,6 +500,112 @@ int MapObjectModel::removeObject(ObjectGroup *og, MapObject *o)
     return row;
 }
 
+/**
+ * Inserts the objects described by \a entries. An index of -1 appends the
+ * object to its group. Entries with explicit indexes need to be sorted by
+ * index within each group, as returned by removeObjects().
+ *
+ * Consecutive entries ending up next to each other are inserted as a single
+ * range of rows, and objectsAdded() is emitted only once at the end.
+ */
+void MapObjectModel::insertObjects(const QVector<ObjectEntry> &entries)
+{
+    QList<MapObject*> objects;
+    objects.reserve(entries.size());
+
+    mChangingObjects = true;
+
+    int begin = 0;
+    while (begin < entries.size()) {
+        const ObjectEntry &firstEntry = entries.at(begin);
+        ObjectGroup *og = firstEntry.objectGroup;
+        const bool append = firstEntry.index < 0;
+        const int first = append ? og->objectCount() : firstEntry.index;
+
+        int end = begin + 1;
+        for (; end < entries.size(); ++end) {
+            const ObjectEntry &entry = entries.at(end);
+            if (entry.objectGroup != og)
+                break;
+            if (append ? entry.index >= 0 : entry.index != first + end - begin)
+                break;
+        }
+
+        beginInsertRows(index(og), first, first + end - begin - 1);
+        for (int i = begin; i < end; ++i) {
+            MapObject *mapObject = entries.at(i).mapObject;
+            og->insertObject(first + i - begin, mapObject);
+            objects.append(mapObject);
+        }
+        endInsertRows();
+
+        begin = end;
+    }
+
+    mChangingObjects = false;
+
+    if (!objects.isEmpty())
+        emit objectsAdded(objects);
+}
+
+/**
+ * Removes the given \a objects from their object groups, one range of rows
+ * at a time, and emits objectsRemoved() once at the end.
+ *
+ * Returns the removed objects along with their former position, sorted by
+ * index within each group, so that they can be passed to insertObjects() to
+ * restore them.
+ */
+QVector<MapObjectModel::ObjectEntry> MapObjectModel::removeObjects(const QList<MapObject *> &objects)
+{
+    QVector<ObjectEntry> entries;
+    entries.reserve(objects.size());
+
+    for (MapObject *mapObject : objects) {
+        ObjectGroup *og = mapObject->objectGroup();
+        entries.append(ObjectEntry { og, og->objectIndex(mapObject), mapObject });
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [] (const ObjectEntry &a, const ObjectEntry &b) {
+        if (a.objectGroup != b.objectGroup)
+            return std::less<ObjectGroup*>()(a.objectGroup, b.objectGroup);
+        return a.index < b.index;
+    });
+
+    mChangingObjects = true;
+
+    // Remove from the back, so that the remaining indexes stay valid
+    int end = entries.size();
+    while (end > 0) {
+        ObjectGroup *og = entries.at(end - 1).objectGroup;
+        const int last = entries.at(end - 1).index;
+
+        int begin = end - 1;
+        while (begin > 0 &&
+               entries.at(begin - 1).objectGroup == og &&
+               entries.at(begin - 1).index == entries.at(begin).index - 1) {
+            --begin;
+        }
+
+        const int first = entries.at(begin).index;
+
+        beginRemoveRows(index(og), first, last);
+        for (int row = last; row >= first; --row)
+            og->removeObjectAt(row);
+        endRemoveRows();
+
+        end = begin;
+    }
+
+    mChangingObjects = false;
+
+    if (!objects.isEmpty())
+        emit objectsRemoved(objects);
+
+    return entries;
+}
+
 void MapObjectModel::moveObjects(ObjectGroup *og, int from, int to, int count)
 {
     const QModelIndex parent = index(og);
@@ -62,6 +62,16 @@ public:
         ColumnCount
     };
 
+    /**
+     * An object along with the object group it belongs to and its index
+     * within that group. Used when adding or removing objects in bulk.
+     */
+    struct ObjectEntry {
+        ObjectGroup *objectGroup;
+        int index;
+        MapObject *mapObject;
+    };
+
     MapObjectModel(QObject *parent = nullptr);
 
     QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
@@ -91,6 +101,9 @@ public:
 
     void insertObject(ObjectGroup *og, int index, MapObject *o);
     int removeObject(ObjectGroup *og, MapObject *o);
+    void insertObjects(const QVector<ObjectEntry> &entries);
+    QVector<ObjectEntry> removeObjects(const QList<MapObject*> &objects);
+    bool isChangingObjects() const { return mChangingObjects; }
     void moveObjects(ObjectGroup *og, int from, int to, int count);
 
     void setObjectPolygon(MapObject *o, const QPolygonF &polygon);
@@ -125,6 +138,7 @@ private:
     QList<Layer *> &filteredChildLayers(GroupLayer *parentLayer) const;
 
     QIcon mObjectGroupIcon;
+    bool mChangingObjects;
 };
 
 } // namespace Internal
@@ -25,23 +25,29 @@
 
 #include "abstracttool.h"
 #include "addremovemapobject.h"
+#include "backgroundmapreader.h"
 #include "containerhelpers.h"
 #include "documentmanager.h"
 #include "map.h"
 #include "mapobject.h"
 #include "maprenderer.h"
 #include "objectgroup.h"
+#include "objectgroupitem.h"
 #include "objecttemplate.h"
 #include "preferences.h"
 #include "stylehelper.h"
 #include "templatemanager.h"
 #include "tilesetmanager.h"
+#include "tmxmapformat.h"
 #include "toolmanager.h"
 #include "worldmanager.h"
 
 #include <QApplication>
+#include <QGraphicsSceneHelpEvent>
 #include <QGraphicsSceneMouseEvent>
+#include <QGraphicsView>
 #include <QKeyEvent>
+#include <QLineF>
 #include <QMimeData>
 #include <QPalette>
 
@@ -78,6 +84,10 @@ MapScene::MapScene(QObject *parent):
     WorldManager &worldManager = WorldManager::instance();
     connect(&worldManager, &WorldManager::worldsChanged, this, &MapScene::refreshScene);
 
+    mWorldMapsUpdateTimer.setSingleShot(true);
+    connect(&mWorldMapsUpdateTimer, &QTimer::timeout,
+            this, &MapScene::updateWorldMaps);
+
     // Install an event filter so that we can get key events on behalf of the
     // active tool without having to have the current focus.
     qApp->installEventFilter(this);
@@ -131,48 +141,67 @@ void MapScene::refreshScene()
 {
     QHash<MapDocument*, MapItem*> mapItems;
 
+    QHash<QString, MapItem*> worldMapItems;
+
+    mWorldMaps.clear();
+    mUnavailableWorldMaps.clear();
+    mWorldMapsUpdateTimer.stop();
+
     if (!mMapDocument) {
         mMapItems.swap(mapItems);
+        mWorldMapItems.swap(worldMapItems);
         qDeleteAll(mapItems);
         updateSceneRect();
         return;
     }
 
     WorldManager &worldManager = WorldManager::instance();
+    const QString &fileName = mMapDocument->fileName();
 
-    if (const World *world = worldManager.worldForMap(mMapDocument->fileName())) {
-        const QPoint currentMapPosition = world->mapRect(mMapDocument->fileName()).topLeft();
-        auto const contextMaps = world->contextMaps(mMapDocument->fileName());
+    if (const World *world = worldManager.worldForMap(fileName)) {
+        mCurrentMapPosition = world->mapRect(fileName).topLeft();
+        auto const contextMaps = world->contextMaps(fileName);
 
+        QHash<QString, MapItem*> itemsByFileName;
+        for (MapItem *mapItem : qAsConst(mMapItems))
+            itemsByFileName.insert(mapItem->mapDocument()->fileName(), mapItem);
+        for (auto it = mWorldMapItems.constBegin(); it != mWorldMapItems.constEnd(); ++it)
+            itemsByFileName.insert(it.key(), it.value());
+
+        // Keep the maps that are already displayed. The others are loaded
+        // on demand by updateWorldMaps, depending on the visible area.
         for (const World::MapEntry &mapEntry : contextMaps) {
-            MapDocumentPtr mapDocument;
+            if (mapEntry.fileName == fileName)
+                continue;
 
-            if (mapEntry.fileName == mMapDocument->fileName()) {
-                mapDocument = mMapDocument->sharedFromThis();
-            } else {
-                auto doc = DocumentManager::instance()->loadDocument(mapEntry.fileName);
-                mapDocument = doc.objectCast<MapDocument>();
-            }
+            mWorldMaps.append(mapEntry);
 
-            if (mapDocument) {
-                MapItem::DisplayMode displayMode = MapItem::ReadOnly;
-                if (mapDocument == mMapDocument)
-                    displayMode = MapItem::Editable;
+            MapItem *mapItem = itemsByFileName.value(mapEntry.fileName);
+            if (!mapItem)
+                continue;
 
-                auto mapItem = takeOrCreateMapItem(mapDocument, displayMode);
-                mapItem->setPos(mapEntry.rect.topLeft() - currentMapPosition);
-                mapItems.insert(mapDocument.data(), mapItem);
-            }
+            MapDocument *mapDocument = mapItem->mapDocument();
+            if (mapDocument == mMapDocument || !mMapItems.contains(mapDocument))
+                continue;
+
+            mMapItems.remove(mapDocument);
+            mapItem->setDisplayMode(MapItem::ReadOnly);
+            mapItem->setPos(mapEntry.rect.topLeft() - mCurrentMapPosition);
+            mapItems.insert(mapDocument, mapItem);
+            worldMapItems.insert(mapEntry.fileName, mapItem);
         }
-    } else {
-        auto mapItem = takeOrCreateMapItem(mMapDocument->sharedFromThis(), MapItem::Editable);
-        mapItems.insert(mMapDocument, mapItem);
     }
 
+    auto mapItem = takeOrCreateMapItem(mMapDocument->sharedFromThis(), MapItem::Editable);
+    mapItem->setPos(QPointF());
+    mapItems.insert(mMapDocument, mapItem);
+
     mMapItems.swap(mapItems);
+    mWorldMapItems.swap(worldMapItems);
     qDeleteAll(mapItems);       // delete all map items that didn't get reused
 
     updateSceneRect();
+    scheduleWorldMapsUpdate();
 
     const Map *map = mMapDocument->map();
 
@@ -197,9 +226,173 @@ void MapScene::updateSceneRect()
     for (MapItem *mapItem : qAsConst(mMapItems))
         sceneRect |= mapItem->boundingRect().translated(mapItem->pos());
 
+    // Include the world maps that are not loaded, so they can be scrolled to
+    for (const World::MapEntry &mapEntry : qAsConst(mWorldMaps))
+        sceneRect |= QRectF(mapEntry.rect.translated(-mCurrentMapPosition));
+
     setSceneRect(sceneRect);
 }
 
+/**
+ * Returns the part of the scene visible in any of its views, or the current
+ * map when the scene is not shown.
+ */
+QRectF MapScene::visibleSceneRect() const
+{
+    QRectF rect;
+
+    const auto sceneViews = views();
+    for (QGraphicsView *view : sceneViews)
+        rect |= view->mapToScene(view->viewport()->rect()).boundingRect();
+
+    if (rect.isEmpty())
+        if (MapItem *mapItem = mMapItems.value(mMapDocument))
+            rect = mapItem->boundingRect();
+
+    return rect;
+}
+
+/**
+ * Requests the loaded world maps to be updated for a changed visible area.
+ */
+void MapScene::scheduleWorldMapsUpdate()
+{
+    if (!mWorldMaps.isEmpty())
+        mWorldMapsUpdateTimer.start(0);
+}
+
+/**
+ * Loads the world maps near the visible area and releases the ones that are
+ * far away from it.
+ *
+ * Only the missing map closest to the center of the view is loaded at a
+ * time, after which another update is scheduled. Maps in the TMX format are
+ * read on the thread pool and only their tilesets and images are loaded on
+ * the main thread, so the neighbouring maps stream in without blocking the
+ * event loop. Other formats are still read on the main thread.
+ */
+void MapScene::updateWorldMaps()
+{
+    if (!mMapDocument || mWorldMaps.isEmpty())
+        return;
+
+    const QRectF visibleRect = visibleSceneRect();
+    const QPointF center = visibleRect.center();
+    const qreal width = visibleRect.width();
+    const qreal height = visibleRect.height();
+
+    // Load maps within one screen of the visible area, and keep them until
+    // they are more than two screens away
+    const QRectF loadRect = visibleRect.adjusted(-width, -height, width, height);
+    const QRectF keepRect = loadRect.adjusted(-width, -height, width, height);
+
+    const World::MapEntry *nearestEntry = nullptr;
+    qreal nearestDistance = 0;
+    bool itemsChanged = false;
+
+    for (const World::MapEntry &mapEntry : qAsConst(mWorldMaps)) {
+        const QRectF rect(mapEntry.rect.translated(-mCurrentMapPosition));
+
+        if (MapItem *mapItem = mWorldMapItems.value(mapEntry.fileName)) {
+            if (!rect.intersects(keepRect)) {
+                mWorldMapItems.remove(mapEntry.fileName);
+                mMapItems.remove(mapItem->mapDocument());
+                delete mapItem;
+                itemsChanged = true;
+            }
+        } else if (rect.intersects(loadRect) && !mUnavailableWorldMaps.contains(mapEntry.fileName)) {
+            const qreal distance = QLineF(center, rect.center()).length();
+            if (!nearestEntry || distance < nearestDistance) {
+                nearestEntry = &mapEntry;
+                nearestDistance = distance;
+            }
+        }
+    }
+
+    // Wait for the map that is being read before loading the next one
+    if (!mReadingWorldMap.isEmpty())
+        nearestEntry = nullptr;
+
+    if (nearestEntry) {
+        const QString &fileName = nearestEntry->fileName;
+        DocumentManager *documentManager = DocumentManager::instance();
+        DocumentPtr document = documentManager->findLoadedDocument(fileName);
+        MapFormat *format = document ? nullptr : findSupportingMapFormat(fileName);
+
+        if (qobject_cast<TmxMapFormat*>(format)) {
+            auto reader = new BackgroundMapReader(fileName, format);
+            connect(reader, &BackgroundMapReader::finished, this, &MapScene::worldMapRead);
+            connect(reader, &BackgroundMapReader::finished, reader, &QObject::deleteLater);
+
+            mReadingWorldMap = fileName;
+            reader->start();
+        } else {
+            if (!document)
+                document = documentManager->loadDocument(fileName);
+
+            addWorldMap(*nearestEntry, document.objectCast<MapDocument>());
+            itemsChanged = true;
+
+            // Continue with the next map in the next event loop iteration
+            mWorldMapsUpdateTimer.start(0);
+        }
+    }
+
+    if (itemsChanged)
+        updateSceneRect();
+}
+
+/**
+ * Adds the world map that has been read in the background, unless it is no
+ * longer part of the displayed world.
+ */
+void MapScene::worldMapRead()
+{
+    auto reader = static_cast<BackgroundMapReader*>(sender());
+    const QString &fileName = reader->fileName();
+
+    if (mReadingWorldMap == fileName)
+        mReadingWorldMap.clear();
+
+    const World::MapEntry *mapEntry = worldMapEntry(fileName);
+    if (mapEntry && !mWorldMapItems.contains(fileName)) {
+        // The map may have been opened in the meantime
+        DocumentPtr document = DocumentManager::instance()->findLoadedDocument(fileName);
+        if (!document)
+            document = reader->takeMapDocument();
+
+        addWorldMap(*mapEntry, document.objectCast<MapDocument>());
+        updateSceneRect();
+    }
+
+    scheduleWorldMapsUpdate();
+}
+
+const World::MapEntry *MapScene::worldMapEntry(const QString &fileName) const
+{
+    for (const World::MapEntry &mapEntry : qAsConst(mWorldMaps))
+        if (mapEntry.fileName == fileName)
+            return &mapEntry;
+
+    return nullptr;
+}
+
+void MapScene::addWorldMap(const World::MapEntry &mapEntry,
+                           const MapDocumentPtr &mapDocument)
+{
+    // Skip maps that failed to load or that are already displayed under a
+    // different file name
+    if (!mapDocument || mMapItems.contains(mapDocument.data())) {
+        mUnavailableWorldMaps.insert(mapEntry.fileName);
+        return;
+    }
+
+    auto mapItem = takeOrCreateMapItem(mapDocument, MapItem::ReadOnly);
+    mapItem->setPos(mapEntry.rect.topLeft() - mCurrentMapPosition);
+    mMapItems.insert(mapDocument.data(), mapItem);
+    mWorldMapItems.insert(mapEntry.fileName, mapItem);
+}
+
 MapItem *MapScene::takeOrCreateMapItem(const MapDocumentPtr &mapDocument, MapItem::DisplayMode displayMode)
 {
     // Try to reuse an existing map item ʹѴڵmap item
@@ -365,6 +558,35 @@ bool MapScene::event(QEvent *event)
     return QGraphicsScene::event(event);
 }
 
+/**
+ * Override to show the tooltips of objects drawn by an ObjectGroupItem. Items
+ * that have their own tooltip, like the MapObjectItem of a hovered object,
+ * are still handled by the default implementation.
+ */
+void MapScene::helpEvent(QGraphicsSceneHelpEvent *event)
+{
+    QTransform deviceTransform;
+    if (QWidget *viewport = event->widget())
+        if (QGraphicsView *view = qobject_cast<QGraphicsView*>(viewport->parentWidget()))
+            deviceTransform = view->viewportTransform();
+
+    const QList<QGraphicsItem*> itemsAtPos = items(event->scenePos(),
+                                                   Qt::IntersectsItemShape,
+                                                   Qt::DescendingOrder,
+                                                   deviceTransform);
+
+    for (QGraphicsItem *item : itemsAtPos) {
+        if (!item->toolTip().isEmpty())
+            break;
+
+        if (ObjectGroupItem *objectGroupItem = dynamic_cast<ObjectGroupItem*>(item))
+            if (objectGroupItem->helpEvent(event))
+                return;
+    }
+
+    QGraphicsScene::helpEvent(event);
+}
+
 void MapScene::keyPressEvent(QKeyEvent *event)
 {
     if (mActiveTool)
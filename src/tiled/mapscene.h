@@ -25,10 +25,14 @@
 
 #include "mapdocument.h"
 #include "mapitem.h"
+#include "worldmanager.h"
 
 #include <QColor>
 #include <QGraphicsScene>
 #include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
 
 namespace Tiled {
 
@@ -67,10 +71,13 @@ public:
 
     void setSelectedTool(AbstractTool *tool);
 
+    void scheduleWorldMapsUpdate();
+
 protected:
     void drawForeground(QPainter *painter, const QRectF &rect) override;
 
     bool event(QEvent *event) override;
+    void helpEvent(QGraphicsSceneHelpEvent *event) override;
 
     void keyPressEvent(QKeyEvent *event) override;
     void mouseMoveEvent(QGraphicsSceneMouseEvent *mouseEvent) override;
@@ -87,6 +94,8 @@ private slots:
     void setGridVisible(bool visible);
 
     void refreshScene();
+    void updateWorldMaps();
+    void worldMapRead();
 
     void currentLayerChanged();
 
@@ -103,6 +112,11 @@ private slots:
 private:
     void updateDefaultBackgroundColor();
     void updateSceneRect();
+    QRectF visibleSceneRect() const;
+
+    const World::MapEntry *worldMapEntry(const QString &fileName) const;
+    void addWorldMap(const World::MapEntry &mapEntry,
+                     const MapDocumentPtr &mapDocument);
 
     MapItem *takeOrCreateMapItem(const MapDocumentPtr &mapDocument,
                                  MapItem::DisplayMode displayMode);
@@ -111,6 +125,12 @@ private:
 
     MapDocument *mMapDocument;
     QHash<MapDocument*, MapItem*> mMapItems;
+    QVector<World::MapEntry> mWorldMaps;    // Excluding the current map
+    QHash<QString, MapItem*> mWorldMapItems;
+    QSet<QString> mUnavailableWorldMaps;
+    QString mReadingWorldMap;               // Being read in the background
+    QPoint mCurrentMapPosition;
+    QTimer mWorldMapsUpdateTimer;
     AbstractTool *mSelectedTool;
     AbstractTool *mActiveTool;
     bool mGridVisible;
@@ -117,6 +117,9 @@ void MapView::adjustScale(qreal scale)
 
     setRenderHint(QPainter::SmoothPixmapTransform,
                   mZoomable->smoothTransform());
+
+    if (MapScene *scene = mapScene())
+        scene->scheduleWorldMapsUpdate();
 }
 
 void MapView::setUseOpenGL(bool useOpenGL)
@@ -263,6 +266,20 @@ void MapView::resizeEvent(QResizeEvent *event)
         updateSceneRect(s->sceneRect());
 
     QGraphicsView::resizeEvent(event);
+
+    if (MapScene *scene = mapScene())
+        scene->scheduleWorldMapsUpdate();
+}
+
+/**
+ * Lets the scene load the world maps that scrolled into view.
+ */
+void MapView::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+
+    if (MapScene *scene = mapScene())
+        scene->scheduleWorldMapsUpdate();
 }
 
 void MapView::keyPressEvent(QKeyEvent *event)
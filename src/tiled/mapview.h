@@ -72,6 +72,7 @@ protected:
 
     void hideEvent(QHideEvent *) override;
     void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
 
     void keyPressEvent(QKeyEvent *event) override;
 
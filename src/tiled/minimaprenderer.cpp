@@ -68,6 +68,19 @@ MiniMapRenderer::~MiniMapRenderer()
     delete mRenderer;
 }
 
+/**
+ * Returns the size of the map in pixels, including the space needed for
+ * layer offsets.
+ */
+QSize MiniMapRenderer::mapSize() const
+{
+    QSize size = mRenderer->mapBoundingRect().size();
+    const QMargins margins = mMap->computeLayerOffsetMargins();
+    size.setWidth(size.width() + margins.left() + margins.right());
+    size.setHeight(size.height() + margins.top() + margins.bottom());
+    return size;
+}
+
 QImage MiniMapRenderer::render(QSize size, RenderFlags renderFlags) const
 {
     QImage image(size, QImage::Format_ARGB32_Premultiplied);
@@ -132,11 +145,31 @@ static void extendMapRect(QRect &mapBoundingRect, const MapRenderer &renderer)
     mapBoundingRect = rect.toAlignedRect();
 }
 
+/**
+ * Returns the area of the \a image covered by the \a painter, in the current
+ * coordinates of the painter.
+ */
+static QRectF exposedRect(const QPainter &painter, const QImage &image)
+{
+    return painter.transform().inverted().mapRect(QRectF(image.rect()));
+}
+
 void MiniMapRenderer::renderToImage(QImage& image, RenderFlags renderFlags) const
+{
+    renderToImage(image, renderFlags, image.size(), QPoint());
+}
+
+/**
+ * Renders the part at \a imageOffset of the map rendered at \a imageSize
+ * into the given \a image. This allows rendering maps that are too large to
+ * fit into a single image in several parts.
+ */
+void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags,
+                                    QSize imageSize, QPoint imageOffset) const
 {
     if (!mMap)
         return;
-    if (image.isNull())
+    if (image.isNull() || imageSize.isEmpty())
         return;
 
     bool drawObjects = renderFlags.testFlag(RenderFlag::DrawMapObjects);
@@ -156,8 +189,8 @@ void MiniMapRenderer::renderToImage(QImage& image, RenderFlags renderFlags) cons
     mapSize.setHeight(mapSize.height() + margins.top() + margins.bottom());
 
     // Determine the largest possible scale
-    qreal scale = qMin(static_cast<qreal>(image.width()) / mapSize.width(),
-                       static_cast<qreal>(image.height()) / mapSize.height());
+    qreal scale = qMin(static_cast<qreal>(imageSize.width()) / mapSize.width(),
+                       static_cast<qreal>(imageSize.height()) / mapSize.height());
 
     if (renderFlags.testFlag(DrawBackground)) {
         if (mMap->backgroundColor().isValid())
@@ -173,9 +206,10 @@ void MiniMapRenderer::renderToImage(QImage& image, RenderFlags renderFlags) cons
 
     // Center the map in the requested size
     QSize scaledMapSize = mapSize * scale;
-    QPointF centerOffset((image.width() - scaledMapSize.width()) / 2,
-                         (image.height() - scaledMapSize.height()) / 2);
+    QPointF centerOffset((imageSize.width() - scaledMapSize.width()) / 2,
+                         (imageSize.height() - scaledMapSize.height()) / 2);
 
+    painter.translate(-imageOffset);
     painter.translate(centerOffset);
     painter.scale(scale, scale);
     painter.translate(margins.left(), margins.top());
@@ -197,7 +231,7 @@ void MiniMapRenderer::renderToImage(QImage& image, RenderFlags renderFlags) cons
         case Layer::TileLayerType: {
             if (drawTileLayers) {
                 const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
-                mRenderer->drawTileLayer(&painter, tileLayer);
+                mRenderer->drawTileLayer(&painter, tileLayer, exposedRect(painter, image));
             }
             break;
         }
@@ -233,7 +267,7 @@ void MiniMapRenderer::renderToImage(QImage& image, RenderFlags renderFlags) cons
         case Layer::ImageLayerType: {
             if (drawImageLayers) {
                 const ImageLayer *imageLayer = static_cast<const ImageLayer*>(layer);
-                mRenderer->drawImageLayer(&painter, imageLayer);
+                mRenderer->drawImageLayer(&painter, imageLayer, exposedRect(painter, image));
             }
             break;
         }
@@ -248,6 +282,8 @@ void MiniMapRenderer::renderToImage(QImage& image, RenderFlags renderFlags) cons
 
     if (drawTileGrid) {
         Preferences *prefs = Preferences::instance();
-        mRenderer->drawGrid(&painter, mapBoundingRect, prefs->gridColor());
+        const QRectF gridRect = QRectF(mapBoundingRect) & exposedRect(painter, image);
+        if (!gridRect.isEmpty())
+            mRenderer->drawGrid(&painter, gridRect, prefs->gridColor());
     }
 }
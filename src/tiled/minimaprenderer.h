@@ -50,9 +50,13 @@ public:
     MiniMapRenderer(Map *map);
     ~MiniMapRenderer();
 
+    QSize mapSize() const;
+
     QImage render(QSize size, RenderFlags renderFlags) const;
 
     void renderToImage(QImage &image, RenderFlags renderFlags) const;
+    void renderToImage(QImage &image, RenderFlags renderFlags,
+                       QSize imageSize, QPoint imageOffset) const;
 
 private:
     Map *mMap;
@@ -52,7 +52,7 @@ void MoveMapObjectToGroup::undo()
 void MoveMapObjectToGroup::redo()
 {
     mOldObjectGroup = mMapObject->objectGroup();
-    mOldIndex = mOldObjectGroup->objects().indexOf(mMapObject);
+    mOldIndex = mMapObject->index();
 
     mMapDocument->mapObjectModel()->removeObject(mOldObjectGroup, mMapObject);
     mMapDocument->mapObjectModel()->insertObject(mNewObjectGroup, -1, mMapObject);
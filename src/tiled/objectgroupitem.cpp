@@ -20,23 +20,269 @@
 
 #include "objectgroupitem.h"
 
+#include "geometry.h"
+#include "mapdocument.h"
+#include "mapobject.h"
+#include "mapobjectitem.h"
+#include "maprenderer.h"
+#include "mapview.h"
+#include "zoomable.h"
+
+#include <QGraphicsSceneHelpEvent>
+#include <QStyleOptionGraphicsItem>
+#include <QToolTip>
+
+#include <algorithm>
+
 using namespace Tiled;
 using namespace Tiled::Internal;
 
 ObjectGroupItem::ObjectGroupItem(ObjectGroup *objectGroup, QGraphicsItem *parent)
     : LayerItem(objectGroup, parent)
+    , mMapDocument(nullptr)
 {
     // Since we don't do any painting, we can spare us the call to paint()
     setFlag(QGraphicsItem::ItemHasNoContents);
 }
 
+ObjectGroupItem::ObjectGroupItem(ObjectGroup *objectGroup,
+                                 MapDocument *mapDocument,
+                                 QGraphicsItem *parent)
+    : LayerItem(objectGroup, parent)
+    , mMapDocument(mapDocument)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+
+    syncWithObjects();
+}
+
+void ObjectGroupItem::syncWithObjects()
+{
+    if (!mMapDocument)
+        return;
+
+    prepareGeometryChange();
+
+    mObjectInfo.clear();
+    mObjectInfo.reserve(objectGroup()->objectCount());
+    mBoundingRect = QRectF();
+
+    for (MapObject *object : objectGroup()->objects()) {
+        const ObjectInfo info = objectInfo(object);
+        mBoundingRect |= info.bounds;
+        mObjectInfo.insert(object, info);
+    }
+
+    update();
+}
+
+void ObjectGroupItem::syncWithObjects(const QList<MapObject*> &objects)
+{
+    if (!mMapDocument)
+        return;
+
+    for (MapObject *object : objects) {
+        const ObjectInfo info = objectInfo(object);
+
+        auto it = mObjectInfo.find(object);
+        if (it != mObjectInfo.end()) {
+            update(it->bounds);
+            *it = info;
+        } else {
+            mObjectInfo.insert(object, info);
+        }
+
+        // The bounding rect only grows here, it is recomputed on full sync
+        if (!mBoundingRect.contains(info.bounds)) {
+            prepareGeometryChange();
+            mBoundingRect |= info.bounds;
+        }
+
+        update(info.bounds);
+    }
+}
+
+void ObjectGroupItem::removeObjects(const QList<MapObject*> &objects)
+{
+    for (MapObject *object : objects) {
+        auto it = mObjectInfo.find(object);
+        if (it == mObjectInfo.end())
+            continue;
+
+        update(it->bounds);
+        mObjectInfo.erase(it);
+    }
+}
+
 QRectF ObjectGroupItem::boundingRect() const
 {
-    return QRectF();
+    return mBoundingRect;
+}
+
+void ObjectGroupItem::paint(QPainter *painter,
+                            const QStyleOptionGraphicsItem *option,
+                            QWidget *widget)
+{
+    if (!mMapDocument)
+        return;
+
+    qreal scale = 1.0;
+    if (widget)
+        if (MapView *mapView = qobject_cast<MapView*>(widget->parent()))
+            scale = mapView->zoomable()->scale();
+
+    MapRenderer *renderer = mMapDocument->renderer();
+    renderer->setPainterScale(scale);
+
+    // Leave room for point markers and line widths, which are not part of
+    // the object bounds stored in the spatial index
+    const qreal lineWidth = qMax<qreal>(1, renderer->objectLineWidth());
+    const qreal margin = qMax<qreal>(32, 4 * lineWidth / scale);
+
+    const QList<MapObject*> objects = objectsInDrawOrder(option->exposedRect, margin);
+    const bool batchTileObjects = !renderer->testFlag(ShowTileObjectOutlines);
+
+    // Tile objects are collected in a shared cell renderer and the outlines
+    // of shape objects are collected per color. Each is flushed whenever
+    // another object needs to be drawn in between.
+    CellRenderer cellRenderer(painter, CellRenderer::OrthogonalCells, renderer->flags());
+    QVector<QColor> outlineColors;
+    QVector<ObjectOutlines> outlines;
+
+    auto flushOutlines = [&] {
+        for (int i = 0; i < outlines.size(); ++i)
+            renderer->drawObjectOutlines(painter, outlines.at(i), outlineColors.at(i));
+        outlineColors.clear();
+        outlines.clear();
+    };
+
+    auto outlinesForColor = [&] (const QColor &color) -> ObjectOutlines & {
+        int index = outlineColors.indexOf(color);
+        if (index == -1) {
+            index = outlines.size();
+            outlineColors.append(color);
+            outlines.append(ObjectOutlines());
+        }
+        return outlines[index];
+    };
+
+    for (MapObject *object : objects) {
+        if (!object->isVisible())
+            continue;
+
+        const bool isTileObject = !object->cell().isEmpty();
+
+        if (isTileObject && batchTileObjects && object->rotation() == 0.0) {
+            flushOutlines();
+            renderer->drawTileObject(cellRenderer, object);
+            continue;
+        }
+
+        cellRenderer.flush();
+
+        const QPointF screenPos = renderer->pixelToScreenCoords(object->position());
+        const QTransform transform = rotateAt(screenPos, object->rotation());
+        const QColor color = mObjectInfo.value(object).color;
+
+        if (!isTileObject && renderer->addObjectOutline(outlinesForColor(color), object, transform))
+            continue;
+
+        flushOutlines();
+
+        painter->save();
+        painter->setTransform(transform, true);
+        renderer->drawMapObject(painter, object, color);
+        painter->restore();
+    }
+
+    flushOutlines();
+}
+
+MapObject *ObjectGroupItem::objectAt(const QPointF &pos) const
+{
+    if (!mMapDocument)
+        return nullptr;
+
+    const MapRenderer *renderer = mMapDocument->renderer();
+    const QList<MapObject*> objects = objectsInDrawOrder(QRectF(pos, QSizeF()), 32);
+
+    for (int i = objects.size() - 1; i >= 0; --i) {
+        MapObject *object = objects.at(i);
+        if (!object->isVisible())
+            continue;
+
+        const QPointF screenPos = renderer->pixelToScreenCoords(object->position());
+        const QPainterPath shape = rotateAt(screenPos, object->rotation()).map(renderer->shape(object));
+        if (shape.contains(pos))
+            return object;
+    }
+
+    return nullptr;
+}
+
+bool ObjectGroupItem::helpEvent(QGraphicsSceneHelpEvent *event)
+{
+    const MapObject *object = objectAt(mapFromScene(event->scenePos()));
+    if (!object)
+        return false;
+
+    QString toolTip = object->name();
+    const QString &type = object->type();
+    if (!type.isEmpty())
+        toolTip += QLatin1String(" (") + type + QLatin1String(")");
+
+    if (toolTip.isEmpty())
+        return false;
+
+    QToolTip::showText(event->screenPos(), toolTip, event->widget());
+    event->setAccepted(true);
+    return true;
 }
 
-void ObjectGroupItem::paint(QPainter *,
-                            const QStyleOptionGraphicsItem *,
-                            QWidget *)
+ObjectGroupItem::ObjectInfo ObjectGroupItem::objectInfo(const MapObject *object) const
 {
+    const MapRenderer *renderer = mMapDocument->renderer();
+    const QPointF screenPos = renderer->pixelToScreenCoords(object->position());
+
+    ObjectInfo info;
+    info.bounds = rotateAt(screenPos, object->rotation()).mapRect(renderer->boundingRect(object));
+    info.color = MapObjectItem::objectColor(object);
+    return info;
+}
+
+/**
+ * Returns the objects that may be visible in the \a exposed area, extended
+ * by the given \a margin, sorted in the order in which they should be drawn.
+ */
+QList<MapObject*> ObjectGroupItem::objectsInDrawOrder(const QRectF &exposed,
+                                                      qreal margin) const
+{
+    const MapRenderer *renderer = mMapDocument->renderer();
+    const ObjectGroup *group = objectGroup();
+
+    const QRectF screenArea = exposed.adjusted(-margin, -margin, margin, margin);
+    const QPolygonF pixelArea = renderer->screenToPixelCoords(QPolygonF(screenArea));
+    const QList<MapObject*> candidates = group->objectsInRect(pixelArea.boundingRect());
+
+    QList<MapObject*> objects;
+
+    // The candidates are sorted by ID, so restore the order of the objects
+    // in the group, which determines the drawing order.
+    if (candidates.size() == group->objectCount()) {
+        objects = group->objects();
+    } else if (!candidates.isEmpty()) {
+        objects = candidates;
+        std::sort(objects.begin(), objects.end(), [] (MapObject *a, MapObject *b) {
+            return a->index() < b->index();
+        });
+    }
+
+    if (group->drawOrder() == ObjectGroup::TopDownOrder) {
+        std::stable_sort(objects.begin(), objects.end(), [renderer] (MapObject *a, MapObject *b) {
+            return renderer->pixelToScreenCoords(a->position()).y() <
+                    renderer->pixelToScreenCoords(b->position()).y();
+        });
+    }
+
+    return objects;
 }
@@ -24,12 +24,24 @@
 
 #include "objectgroup.h"
 
+#include <QColor>
+#include <QHash>
+
+class QGraphicsSceneHelpEvent;
+
 namespace Tiled {
 namespace Internal {
 
+class MapDocument;
+
 /**
- * A graphics item representing an object group in a QGraphicsView. It only
- * serves to group together the objects belonging to the same object group.
+ * A graphics item representing an object group in a QGraphicsView.
+ *
+ * When constructed with a map document, it draws all the objects in the
+ * object group in a single pass, looking up the objects in the exposed area
+ * using the spatial index of the object group. Tile objects are drawn in
+ * batches, as are the outlines of shape objects sharing the same color.
+ * Otherwise, it only serves to group together MapObjectItem instances.
  *
  * @see MapObjectItem
  */
@@ -37,14 +49,60 @@ class ObjectGroupItem : public LayerItem
 {
 public:
     ObjectGroupItem(ObjectGroup *objectGroup, QGraphicsItem *parent = nullptr);
+    ObjectGroupItem(ObjectGroup *objectGroup, MapDocument *mapDocument,
+                    QGraphicsItem *parent = nullptr);
 
     ObjectGroup *objectGroup() const;
 
+    /**
+     * Should be called when all objects need to be updated, for example
+     * because the map orientation or the object types changed.
+     */
+    void syncWithObjects();
+
+    /**
+     * Should be called when the given \a objects were added or changed.
+     */
+    void syncWithObjects(const QList<MapObject*> &objects);
+
+    /**
+     * Should be called when the given \a objects were removed. Objects that
+     * are not known to this item are ignored.
+     */
+    void removeObjects(const QList<MapObject*> &objects);
+
+    /**
+     * Returns the topmost visible object at \a pos, in item coordinates.
+     */
+    MapObject *objectAt(const QPointF &pos) const;
+
+    /**
+     * Shows the tooltip of the object under the mouse, since the objects
+     * drawn by this item have no items of their own. Called by the MapScene.
+     * Returns whether a tooltip was shown.
+     */
+    bool helpEvent(QGraphicsSceneHelpEvent *event);
+
     // QGraphicsItem
     QRectF boundingRect() const override;
     void paint(QPainter *painter,
                const QStyleOptionGraphicsItem *option,
                QWidget *widget = nullptr) override;
+
+private:
+    struct ObjectInfo
+    {
+        QRectF bounds;  // in item coordinates, including rotation
+        QColor color;
+    };
+
+    ObjectInfo objectInfo(const MapObject *object) const;
+    QList<MapObject*> objectsInDrawOrder(const QRectF &exposed,
+                                         qreal margin) const;
+
+    MapDocument *mMapDocument;
+    QHash<MapObject*, ObjectInfo> mObjectInfo;
+    QRectF mBoundingRect;
 };
 
 inline ObjectGroup *ObjectGroupItem::objectGroup() const
@@ -37,6 +37,7 @@
 #include <QBoxLayout>
 #include <QContextMenuEvent>
 #include <QHeaderView>
+#include <QHash>
 #include <QLabel>
 #include <QMenu>
 #include <QPainter>
@@ -45,6 +46,8 @@
 #include <QToolButton>
 #include <QUrl>
 
+#include <algorithm>
+
 static const char FIRST_COLUMN_WIDTH_KEY[] = "ObjectsDock/FirstSectionSize";
 static const char VISIBLE_COLUMNS_KEY[] = "ObjectsDock/VisibleSections";
 
@@ -525,11 +528,32 @@ void ObjectsView::synchronizeSelectedItems()
     Q_ASSERT(!mSynching);
     Q_ASSERT(mMapDocument);
 
-    QItemSelection itemSelection;
+    // Collect the selected rows per parent, so that they can be selected as
+    // contiguous ranges rather than one range per object
+    QHash<QModelIndex, QVector<int>> selectedRows;
 
     for (MapObject *o : mMapDocument->selectedObjects()) {
-        QModelIndex index = mProxyModel->mapFromSource(mapObjectModel()->index(o));
-        itemSelection.select(index, index);
+        const QModelIndex index = mProxyModel->mapFromSource(mapObjectModel()->index(o));
+        if (index.isValid())
+            selectedRows[index.parent()].append(index.row());
+    }
+
+    QItemSelection itemSelection;
+
+    for (auto it = selectedRows.begin(); it != selectedRows.end(); ++it) {
+        const QModelIndex &parent = it.key();
+        QVector<int> &rows = it.value();
+        std::sort(rows.begin(), rows.end());
+
+        for (int i = 0; i < rows.size(); ) {
+            int last = i;
+            while (last + 1 < rows.size() && rows.at(last + 1) == rows.at(last) + 1)
+                ++last;
+
+            itemSelection.select(mProxyModel->index(rows.at(i), 0, parent),
+                                 mProxyModel->index(rows.at(last), 0, parent));
+            i = last + 1;
+        }
     }
 
     mSynching = true;
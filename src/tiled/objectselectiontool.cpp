@@ -27,7 +27,6 @@
 #include "map.h"
 #include "mapdocument.h"
 #include "mapobject.h"
-#include "mapobjectitem.h"
 #include "mapobjectmodel.h"
 #include "maprenderer.h"
 #include "mapscene.h"
@@ -1073,16 +1072,7 @@ void ObjectSelectionTool::updateSelection(const QPointF &pos,
     rect.setWidth(qMax<qreal>(1, rect.width()));
     rect.setHeight(qMax<qreal>(1, rect.height()));
 
-    QList<MapObject*> selectedObjects;
-
-    const QList<QGraphicsItem *> &items = mapScene()->items(rect);
-    for (QGraphicsItem *item : items) {
-        if (!item->isEnabled())
-            continue;
-        MapObjectItem *mapObjectItem = qgraphicsitem_cast<MapObjectItem*>(item);
-        if (mapObjectItem && mapObjectItem->mapObject()->objectGroup()->isUnlocked())
-            selectedObjects.append(mapObjectItem->mapObject());
-    }
+    QList<MapObject*> selectedObjects = mapObjectsIn(rect);
 
     if (modifiers & (Qt::ControlModifier | Qt::ShiftModifier)) {
         for (MapObject *object : mapDocument()->selectedObjects())
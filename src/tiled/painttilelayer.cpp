@@ -54,17 +54,11 @@ PaintTileLayer::PaintTileLayer(MapDocument *mapDocument,
                                QUndoCommand *parent)
     : QUndoCommand(parent)
     , mMapDocument(mapDocument)
+    , mMemoryUsage(0)
     , mMergeable(false)
 {
-    auto &data = mLayerData[target];
-
-    data.mSource = source->clone();
-    data.mErased = target->copy(x - target->x(),
-                                y - target->y(),
-                                source->width(), source->height());
-    data.mX = x;
-    data.mY = y;
-    data.mPaintedRegion = paintRegion;
+    mLayerData[target].init(target, x, y, source, paintRegion);
+    updateMemoryUsage();
 
     setText(QCoreApplication::translate("Undo Commands", "Paint"));
 }
@@ -75,6 +69,8 @@ PaintTileLayer::~PaintTileLayer()
         delete data.mSource;
         delete data.mErased;
     }
+
+    mMapDocument->addUndoMemoryUsage(-mMemoryUsage);
 }
 
 void PaintTileLayer::undo()
@@ -101,6 +97,54 @@ void PaintTileLayer::redo()
     }
 }
 
+static int alignDown(int value)
+{
+    return value - (value & CHUNK_MASK);
+}
+
+static int alignUp(int value)
+{
+    return alignDown(value + CHUNK_MASK);
+}
+
+/**
+ * Returns the smallest rectangle aligned to the chunk grid that contains
+ * \a rect.
+ */
+static QRect chunkAlignedRect(const QRect &rect)
+{
+    return QRect(QPoint(alignDown(rect.left()), alignDown(rect.top())),
+                 QPoint(alignUp(rect.right() + 1) - 1, alignUp(rect.bottom() + 1) - 1));
+}
+
+void PaintTileLayer::LayerData::init(const TileLayer *target, int x, int y,
+                                     const TileLayer *source, const QRegion &paintRegion)
+{
+    const QRect bounds = chunkAlignedRect(paintRegion.boundingRect());
+
+    mSource = new TileLayer(QString(), bounds.topLeft(), bounds.size());
+    mErased = new TileLayer(QString(), bounds.topLeft(), bounds.size());
+    mX = bounds.left();
+    mY = bounds.top();
+    mPaintedRegion = paintRegion;
+
+    // Only remember the cells within the painted region
+#if QT_VERSION >= 0x050800
+    for (const QRect &rect : paintRegion) {
+#else
+    const auto rects = paintRegion.rects();
+    for (const QRect &rect : rects) {
+#endif
+        for (int _y = rect.top(); _y <= rect.bottom(); ++_y) {
+            for (int _x = rect.left(); _x <= rect.right(); ++_x) {
+                mSource->setCell(_x - mX, _y - mY, source->cellAt(_x - x, _y - y));
+                mErased->setCell(_x - mX, _y - mY, target->cellAt(_x - target->x(),
+                                                                  _y - target->y()));
+            }
+        }
+    }
+}
+
 void PaintTileLayer::LayerData::mergeWith(const PaintTileLayer::LayerData &o)
 {
     if (!mSource) {
@@ -113,37 +157,41 @@ void PaintTileLayer::LayerData::mergeWith(const PaintTileLayer::LayerData &o)
     }
 
     const QRegion newRegion = o.mPaintedRegion.subtracted(mPaintedRegion);
-    const QRegion combinedRegion = mPaintedRegion.united(o.mPaintedRegion);
     const QRect bounds = QRect(mX, mY, mSource->width(), mSource->height());
-    const QRect combinedBounds = combinedRegion.boundingRect();
+    const QRect oBounds = QRect(o.mX, o.mY, o.mSource->width(), o.mSource->height());
+    const QRect combinedBounds = bounds.united(oBounds);
 
-    // Resize the erased tiles and source layers when necessary
+    // Grow the erased tiles and source layers when necessary. Since both
+    // rectangles are chunk aligned, this only moves around whole chunks.
     if (bounds != combinedBounds) {
         const QPoint shift = bounds.topLeft() - combinedBounds.topLeft();
         mErased->resize(combinedBounds.size(), shift);
         mSource->resize(combinedBounds.size(), shift);
+        mX = combinedBounds.left();
+        mY = combinedBounds.top();
     }
 
-    mX = combinedBounds.left();
-    mY = combinedBounds.top();
-    mPaintedRegion = combinedRegion;
+    mPaintedRegion |= o.mPaintedRegion;
 
     // Copy the painted tiles from the other command over
-    const QPoint pos = QPoint(o.mX, o.mY) - combinedBounds.topLeft();
-    mSource->merge(pos, o.mSource);
+    mSource->setCells(o.mX - mX, o.mY - mY, o.mSource,
+                      o.mPaintedRegion.translated(-mX, -mY));
 
     // Copy the newly erased tiles from the other command over
-#if QT_VERSION >= 0x050800
-    for (const QRect &rect : newRegion)
-#else
-    const auto rects = newRegion.rects();
-    for (const QRect &rect : rects)
-#endif
-        for (int y = rect.top(); y <= rect.bottom(); ++y)
-            for (int x = rect.left(); x <= rect.right(); ++x)
-                mErased->setCell(x - mX,
-                                 y - mY,
-                                 o.mErased->cellAt(x - o.mX, y - o.mY));
+    if (!newRegion.isEmpty()) {
+        mErased->setCells(o.mX - mX, o.mY - mY, o.mErased,
+                          newRegion.translated(-mX, -mY));
+    }
+}
+
+/**
+ * Returns an estimate of the memory used by the cells stored for this
+ * layer. Chunks shared with other layers are counted as well.
+ */
+qint64 PaintTileLayer::LayerData::memoryUsage() const
+{
+    const qint64 chunkSize = CHUNK_SIZE * CHUNK_SIZE * sizeof(Cell);
+    return chunkSize * (mSource->chunkCount() + mErased->chunkCount());
 }
 
 bool PaintTileLayer::mergeWith(const QUndoCommand *other)
@@ -160,5 +208,20 @@ bool PaintTileLayer::mergeWith(const QUndoCommand *other)
         mLayerData[it.key()].mergeWith(it.value());
     }
 
+    updateMemoryUsage();
     return true;
 }
+
+/**
+ * Recomputes the memory used by the stored cells and reports the difference
+ * to the map document.
+ */
+void PaintTileLayer::updateMemoryUsage()
+{
+    qint64 usage = 0;
+    for (const LayerData &data : qAsConst(mLayerData))
+        usage += data.memoryUsage();
+
+    mMapDocument->addUndoMemoryUsage(usage - mMemoryUsage);
+    mMemoryUsage = usage;
+}
@@ -85,10 +85,21 @@ public:
     int id() const override { return Cmd_PaintTileLayer; }
     bool mergeWith(const QUndoCommand *other) override;
 
+    qint64 memoryUsage() const;
+
 private:
+    /**
+     * The painted and the erased cells of a single layer. Both are stored in
+     * sparse tile layers, which only allocate the chunks that were painted.
+     * Their origin is aligned to the chunk grid, so that growing them while
+     * merging strokes can share the existing chunks.
+     */
     struct LayerData
     {
+        void init(const TileLayer *target, int x, int y,
+                  const TileLayer *source, const QRegion &paintRegion);
         void mergeWith(const LayerData &o);
+        qint64 memoryUsage() const;
 
         TileLayer *mSource = nullptr;
         TileLayer *mErased = nullptr;
@@ -96,8 +107,11 @@ private:
         QRegion mPaintedRegion;
     };
 
+    void updateMemoryUsage();
+
     MapDocument *mMapDocument;
     QHash<TileLayer*, LayerData> mLayerData;
+    qint64 mMemoryUsage;
     bool mMergeable;
 };
 
@@ -106,5 +120,14 @@ inline void PaintTileLayer::setMergeable(bool mergeable)
     mMergeable = mergeable;
 }
 
+/**
+ * Returns an estimate of the memory used by this command for storing the
+ * painted and erased cells.
+ */
+inline qint64 PaintTileLayer::memoryUsage() const
+{
+    return mMemoryUsage;
+}
+
 } // namespace Internal
 } // namespace Tiled
@@ -87,6 +87,7 @@ Preferences::Preferences()
     mLanguage = stringValue("Language");
     mUseOpenGL = boolValue("OpenGL");
     mWheelZoomsByDefault = boolValue("WheelZoomsByDefault");
+    mUndoMemoryLimit = intValue("UndoMemoryLimit", 0);
     mObjectLabelVisibility = static_cast<ObjectLabelVisiblity>
             (intValue("ObjectLabelVisibility", AllObjectLabels));
     mLabelForHoveredObject = boolValue("LabelForHoveredObject", false);
@@ -685,6 +686,16 @@ void Preferences::setWheelZoomsByDefault(bool mode)
     mSettings->setValue(QLatin1String("Interface/WheelZoomsByDefault"), mode);
 }
 
+void Preferences::setUndoMemoryLimit(int mebibytes)
+{
+    if (mUndoMemoryLimit == mebibytes)
+        return;
+
+    mUndoMemoryLimit = mebibytes;
+    mSettings->setValue(QLatin1String("Interface/UndoMemoryLimit"), mebibytes);
+    emit undoMemoryLimitChanged(mebibytes);
+}
+
 bool Preferences::boolValue(const char *key, bool defaultValue) const
 {
     return mSettings->value(QLatin1String(key), defaultValue).toBool();
@@ -155,6 +155,8 @@ public:
 
     bool wheelZoomsByDefault() const;
 
+    int undoMemoryLimit() const;
+
     /**ṩQSettingsʵķʣ洢/ֵͼʽCamelCase
      * Provides access to the QSettings instance to allow storing/retrieving
      * arbitrary values. The naming style for groups and keys is CamelCase.
@@ -177,6 +179,7 @@ public slots:
     void setOpenLastFilesOnStartup(bool load);
     void setPluginEnabled(const QString &fileName, bool enabled);
     void setWheelZoomsByDefault(bool mode);
+    void setUndoMemoryLimit(int mebibytes);
 
     void clearRecentFiles();
 
@@ -215,6 +218,8 @@ signals:
 
     void checkForUpdatesChanged();
 
+    void undoMemoryLimitChanged(int mebibytes);
+
 private:
     Preferences();
     ~Preferences();
@@ -266,6 +271,7 @@ private:
     bool mIsPatron;
     bool mCheckForUpdates;
     bool mWheelZoomsByDefault;
+    int mUndoMemoryLimit;
 
     static Preferences *mInstance;
 };
@@ -331,5 +337,14 @@ inline bool Preferences::wheelZoomsByDefault() const
     return mWheelZoomsByDefault;
 }
 
+/**
+ * Returns the amount of memory in MiB the tile changes stored in the undo
+ * history of each map may use, or 0 when it is not limited.
+ */
+inline int Preferences::undoMemoryLimit() const
+{
+    return mUndoMemoryLimit;
+}
+
 } // namespace Internal
 } // namespace Tiled
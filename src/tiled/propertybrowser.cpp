@@ -68,6 +68,7 @@
 #include <QDebug>
 #include <QKeyEvent>
 #include <QMessageBox>
+#include <QSet>
 
 namespace Tiled {
 namespace Internal {
@@ -101,6 +102,11 @@ PropertyBrowser::PropertyBrowser(QWidget *parent)
 
     connect(Preferences::instance(), &Preferences::objectTypesChanged,
             this, &PropertyBrowser::objectTypesChanged);
+
+    // Rebuild the custom properties at most once per event loop iteration
+    mCustomPropertiesUpdateTimer.setSingleShot(true);
+    connect(&mCustomPropertiesUpdateTimer, &QTimer::timeout,
+            this, &PropertyBrowser::updateCustomProperties);
 }
 
 void PropertyBrowser::setObject(Object *object)
@@ -134,6 +140,8 @@ void PropertyBrowser::setDocument(Document *document)
     mMapDocument = mapDocument;
     mTilesetDocument = tilesetDocument;
 
+    clearAggregatedProperties();
+
     if (mapDocument) {
         connect(mapDocument, &MapDocument::mapChanged,
                 this, &PropertyBrowser::mapChanged);
@@ -261,7 +269,7 @@ void PropertyBrowser::objectsTypeChanged(const QList<MapObject *> &objects)
 {
     if (mObject && mObject->typeId() == Object::MapObjectType)
         if (objects.contains(static_cast<MapObject*>(mObject)))
-            updateCustomProperties();
+            scheduleCustomPropertiesUpdate();
 }
 
 void PropertyBrowser::layerChanged(Layer *layer)
@@ -286,7 +294,7 @@ void PropertyBrowser::tilesetChanged(Tileset *tileset)
 {
     if (mObject == tileset) {
         updateProperties();
-        updateCustomProperties();   // Tileset may have been swapped
+        scheduleCustomPropertiesUpdate();   // Tileset may have been swapped
     }
 }
 
@@ -300,7 +308,7 @@ void PropertyBrowser::tileTypeChanged(Tile *tile)
 {
     if (mObject == tile) {
         updateProperties();
-        updateCustomProperties();
+        scheduleCustomPropertiesUpdate();
     } else if (mObject && mObject->typeId() == Object::MapObjectType) {
         auto mapObject = static_cast<MapObject*>(mObject);
         if (mapObject->cell().tile() == tile && mapObject->type().isEmpty())
@@ -354,23 +362,12 @@ static QVariant predefinedPropertyValue(Object *object, const QString &name)
     if (objectType.isEmpty())
         return QVariant();
 
-    for (const ObjectType &type : Object::objectTypes()) {
-        if (type.name == objectType)
-            if (type.defaultProperties.contains(name))
-                return type.defaultProperties.value(name);
-    }
+    if (const ObjectType *type = Object::objectType(objectType))
+        return type->defaultProperties.value(name);
 
     return QVariant();
 }
 
-static bool anyObjectHasProperty(const QList<Object*> &objects, const QString &name)
-{
-    for (Object *obj : objects) {
-        if (obj->hasProperty(name))
-            return true;
-    }
-    return false;
-}
 
 static bool propertyValueAffected(Object *currentObject,
                                   Object *changedObject,
@@ -389,7 +386,8 @@ static bool propertyValueAffected(Object *currentObject,
     return false;
 }
 //ص
-static bool objectPropertiesRelevant(Document *document, Object *object)
+static bool objectPropertiesRelevant(Document *document, Object *object,
+                                     const QHash<Object*, Properties> &selectedObjects)
 {
     auto currentObject = document->currentObject();
     if (!currentObject)
@@ -402,7 +400,7 @@ static bool objectPropertiesRelevant(Document *document, Object *object)
         if (static_cast<MapObject*>(currentObject)->cell().tile() == object)
             return true;
 
-    if (document->currentObjects().contains(object))
+    if (selectedObjects.contains(object))
         return true;
 
     return false;
@@ -410,7 +408,9 @@ static bool objectPropertiesRelevant(Document *document, Object *object)
 
 void PropertyBrowser::propertyAdded(Object *object, const QString &name)
 {
-    if (!objectPropertiesRelevant(mDocument, object))
+    reaggregateProperties(object);
+
+    if (!objectPropertiesRelevant(mDocument, object, mAggregatedObjects))
         return;
     if (mNameToProperty.contains(name)) {
         if (propertyValueAffected(mObject, object, name))
@@ -429,16 +429,17 @@ void PropertyBrowser::propertyAdded(Object *object, const QString &name)
 
 void PropertyBrowser::propertyRemoved(Object *object, const QString &name)
 {
+    reaggregateProperties(object);
+
     auto property = mNameToProperty.value(name);
     if (!property)
         return;
-    if (!objectPropertiesRelevant(mDocument, object))
+    if (!objectPropertiesRelevant(mDocument, object, mAggregatedObjects))
         return;
 
     QVariant predefinedValue = predefinedPropertyValue(mObject, name);
 
-    if (!predefinedValue.isValid() &&
-            !anyObjectHasProperty(mDocument->currentObjects(), name)) {
+    if (!predefinedValue.isValid() && !mAggregatedProperties.contains(name)) {
         // It's not a predefined property and no selected object has this
         // property, so delete it.
 
@@ -470,37 +471,39 @@ void PropertyBrowser::propertyRemoved(Object *object, const QString &name)
 
 void PropertyBrowser::propertyChanged(Object *object, const QString &name)
 {
-    auto property = mNameToProperty[name];
+    reaggregateProperties(object);
+
+    auto property = mNameToProperty.value(name);
     if (!property)
         return;
 
     if (propertyValueAffected(mObject, object, name))
         setCustomPropertyValue(property, object->property(name));
 
-    if (mDocument->currentObjects().contains(object))
+    if (mAggregatedObjects.contains(object))
         updateCustomPropertyColor(name);
 }
 
 void PropertyBrowser::propertiesChanged(Object *object)
 {
-    if (objectPropertiesRelevant(mDocument, object))
-        updateCustomProperties();
+    if (objectPropertiesRelevant(mDocument, object, mAggregatedObjects))
+        scheduleCustomPropertiesUpdate();
 }
 
 void PropertyBrowser::selectedObjectsChanged()
 {
-    updateCustomProperties();
+    scheduleCustomPropertiesUpdate();
 }
 
 void PropertyBrowser::selectedTilesChanged()
 {
-    updateCustomProperties();
+    scheduleCustomPropertiesUpdate();
 }
 
 void PropertyBrowser::objectTypesChanged()
 {
     if (mObject && mObject->typeId() == Object::MapObjectType)
-        updateCustomProperties();
+        scheduleCustomPropertiesUpdate();
 }
 
 void PropertyBrowser::valueChanged(QtProperty *property, const QVariant &val)
@@ -1693,8 +1696,15 @@ void PropertyBrowser::updateProperties()
     mUpdating = false;
 }
 
+void PropertyBrowser::scheduleCustomPropertiesUpdate()
+{
+    mCustomPropertiesUpdateTimer.start(0);
+}
+
 void PropertyBrowser::updateCustomProperties()
 {
+    mCustomPropertiesUpdateTimer.stop();
+
     if (!mObject)
         return;
 
@@ -1704,77 +1714,23 @@ void PropertyBrowser::updateCustomProperties()
     qDeleteAll(mNameToProperty);
     mNameToProperty.clear();
 
+    syncAggregatedProperties();
+
     mCombinedProperties = mObject->properties();
     // Add properties from selected objects which mObject does not contain to mCombinedProperties.
-    for (Object *obj : mDocument->currentObjects()) {
-        if (obj == mObject)
-            continue;
-
-        QMapIterator<QString,QVariant> it(obj->properties());
-
-        while (it.hasNext()) {
-            it.next();
-            if (!mCombinedProperties.contains(it.key()))
-                mCombinedProperties.insert(it.key(), QString());
-        }
+    for (auto it = mAggregatedProperties.constBegin(); it != mAggregatedProperties.constEnd(); ++it) {
+        if (!mCombinedProperties.contains(it.key()))
+            mCombinedProperties.insert(it.key(), QString());
     }
 
-    QString objectType;
-
-    switch (mObject->typeId()) {
-    case Object::TileType:
-        objectType = static_cast<Tile*>(mObject)->type();
-        break;
-    case Object::MapObjectType: {
-        auto mapObject = static_cast<MapObject*>(mObject);
-        objectType = mapObject->type();
-
-        // Inherit properties from the template
-        if (const MapObject *templateObject = mapObject->templateObject()) {
-            QMapIterator<QString,QVariant> it(templateObject->properties());
-            while (it.hasNext()) {
-                it.next();
-                if (!mCombinedProperties.contains(it.key()))
-                    mCombinedProperties.insert(it.key(), it.value());
-            }
-        }
-
-        if (Tile *tile = mapObject->cell().tile()) {
-            if (objectType.isEmpty())
-                objectType = tile->type();
-
-            // Inherit properties from the tile
-            QMapIterator<QString,QVariant> it(tile->properties());
-            while (it.hasNext()) {
-                it.next();
-                if (!mCombinedProperties.contains(it.key()))
-                    mCombinedProperties.insert(it.key(), it.value());
-            }
-        }
-        break;
-    }
-    case Object::LayerType:
-    case Object::MapType:
-    case Object::TerrainType:
-    case Object::TilesetType:
-    case Object::WangSetType:
-    case Object::WangColorType:
-    case Object::ObjectTemplateType:
-        break;
-    }
-
-    if (!objectType.isEmpty()) {
-        // Inherit properties from the object type
-        for (const ObjectType &type : Object::objectTypes()) {
-            if (type.name == objectType) {
-                QMapIterator<QString,QVariant> it(type.defaultProperties);
-                while (it.hasNext()) {
-                    it.next();
-                    if (!mCombinedProperties.contains(it.key()))
-                        mCombinedProperties.insert(it.key(), it.value());
-                }
-            }
-        }
+    // Inherit properties from the template, tile and object type. These are
+    // only looked up here, when the current object or its properties change.
+    const Properties inheritedProperties = mObject->inheritedProperties();
+    QMapIterator<QString,QVariant> inheritedIt(inheritedProperties);
+    while (inheritedIt.hasNext()) {
+        inheritedIt.next();
+        if (!mCombinedProperties.contains(inheritedIt.key()))
+            mCombinedProperties.insert(inheritedIt.key(), inheritedIt.value());
     }
 
     QMapIterator<QString,QVariant> it(mCombinedProperties);
@@ -1802,38 +1758,91 @@ void PropertyBrowser::updateCustomPropertyColor(const QString &name)
     if (!property->isEnabled())
         return;
 
-    QString propertyName = property->propertyName();
-    QString propertyValue = property->valueText();
-
-    const auto &objects = mDocument->currentObjects();
+    const AggregatedPropertyData propertyData = mAggregatedProperties.value(name);
 
     QColor textColor = palette().color(QPalette::Active, QPalette::WindowText);
     QColor disabledTextColor = palette().color(QPalette::Disabled, QPalette::WindowText);
 
     // If one of the objects doesn't have this property then gray out the name and value.
-    for (Object *obj : objects) {
-        if (!obj->hasProperty(propertyName)) {
-            property->setNameColor(disabledTextColor);
-            property->setValueColor(disabledTextColor);
-            return;
-        }
+    if (propertyData.presenceCount() < mAggregatedObjects.size()) {
+        property->setNameColor(disabledTextColor);
+        property->setValueColor(disabledTextColor);
+        return;
     }
 
     // If one of the objects doesn't have the same property value then gray out the value.
-    for (Object *obj : objects) {
-        if (obj == mObject)
-            continue;
-        if (obj->property(propertyName) != propertyValue) {
-            property->setNameColor(textColor);
-            property->setValueColor(disabledTextColor);
-            return;
-        }
+    if (!propertyData.valueConsistent()) {
+        property->setNameColor(textColor);
+        property->setValueColor(disabledTextColor);
+        return;
     }
 
     property->setNameColor(textColor);
     property->setValueColor(textColor);
 }
 
+/**
+ * Brings the aggregated properties in line with the current selection, only
+ * adding and removing the objects that were selected or deselected since the
+ * last call.
+ */
+void PropertyBrowser::syncAggregatedProperties()
+{
+    const QList<Object*> objects = mDocument ? mDocument->currentObjects()
+                                             : QList<Object*>();
+
+    QSet<Object*> selectedObjects;
+    selectedObjects.reserve(objects.size());
+
+    for (Object *object : objects) {
+        selectedObjects.insert(object);
+
+        if (mAggregatedObjects.contains(object)) {
+            reaggregateProperties(object);
+        } else {
+            mAggregatedObjects.insert(object, object->properties());
+            mAggregatedProperties.aggregate(object->properties());
+        }
+    }
+
+    // Stored copies are used, since deselected objects may have been deleted
+    auto it = mAggregatedObjects.begin();
+    while (it != mAggregatedObjects.end()) {
+        if (!selectedObjects.contains(it.key())) {
+            mAggregatedProperties.disaggregate(it.value());
+            it = mAggregatedObjects.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * Updates the aggregated properties when the properties of the given
+ * \a object changed, if it is part of the aggregate.
+ */
+void PropertyBrowser::reaggregateProperties(Object *object)
+{
+    auto it = mAggregatedObjects.find(object);
+    if (it == mAggregatedObjects.end())
+        return;
+
+    const Properties &properties = object->properties();
+    if (it.value() == properties)
+        return;
+
+    mAggregatedProperties.disaggregate(it.value());
+    mAggregatedProperties.aggregate(properties);
+    it.value() = properties;
+}
+
+void PropertyBrowser::clearAggregatedProperties()
+{
+    mCustomPropertiesUpdateTimer.stop();
+    mAggregatedObjects.clear();
+    mAggregatedProperties.clear();
+}
+
 void PropertyBrowser::retranslateUi()
 {
     mStaggerAxisNames.clear();
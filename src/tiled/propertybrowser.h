@@ -21,6 +21,7 @@
 #pragma once
 
 #include <QHash>
+#include <QTimer>
 #include <QUndoCommand>
 
 #include <QtTreePropertyBrowser>
@@ -207,9 +208,14 @@ private:
     void addProperties();
     void removeProperties();
     void updateProperties();
+    void scheduleCustomPropertiesUpdate();
     void updateCustomProperties();
     void updateCustomPropertyColor(const QString &name);
 
+    void syncAggregatedProperties();
+    void reaggregateProperties(Object *object);
+    void clearAggregatedProperties();
+
     void retranslateUi();
 
     bool mUpdating;
@@ -227,8 +233,15 @@ private:
     QHash<PropertyId, QtVariantProperty *> mIdToProperty;
     QHash<QString, QtVariantProperty *> mNameToProperty;
 
+    // Own, aggregated and inherited properties of the current object
     Properties mCombinedProperties;
 
+    // Properties of the selected objects, updated as the selection changes
+    QHash<Object*, Properties> mAggregatedObjects;
+    AggregatedProperties mAggregatedProperties;
+
+    QTimer mCustomPropertiesUpdateTimer;
+
     QStringList mStaggerAxisNames;
     QStringList mStaggerIndexNames;
     QStringList mOrientationNames;
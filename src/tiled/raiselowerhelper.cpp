@@ -24,7 +24,6 @@
 #include "geometry.h"
 #include "mapdocument.h"
 #include "mapobject.h"
-#include "mapobjectitem.h"
 #include "maprenderer.h"
 #include "mapscene.h"
 #include "objectgroup.h"
@@ -32,6 +31,8 @@
 
 #include <QCoreApplication>
 
+#include <algorithm>
+
 namespace Tiled {
 namespace Internal {
 //
@@ -230,21 +231,31 @@ bool RaiseLowerHelper::initContext()
         shape |= path;
     }
 
-    // The list of related items are all items from the same object group
-    // that share space with the selected items.
-    const auto items = mMapScene->items(shape,
-                                        Qt::IntersectsItemShape,
-                                        Qt::AscendingOrder);
+    // The list of related objects are all objects from the same object group
+    // that share space with the selected objects.
+    const QPointF offset = mObjectGroup->totalOffset();
+    const QPolygonF pixelArea = renderer->screenToPixelCoords(
+                QPolygonF(shape.boundingRect().translated(-offset)));
+
+    const auto candidates = mObjectGroup->objectsInRect(pixelArea.boundingRect());
 
-    for (QGraphicsItem *item : items) {
-        if (!item->isEnabled())
+    for (MapObject *object : candidates) {
+        if (!object->isVisible())
             continue;
-        if (MapObjectItem *mapObjectItem = qgraphicsitem_cast<MapObjectItem*>(item)) {
-            if (mapObjectItem->mapObject()->objectGroup() == mObjectGroup)
-                mRelatedObjects.append(mapObjectItem->mapObject());
-        }
+
+        QPainterPath path = renderer->shape(object);
+        QPointF screenPos = renderer->pixelToScreenCoords(object->position());
+        path = rotateAt(screenPos, object->rotation()).map(path);
+        path.translate(offset);
+
+        if (path.intersects(shape))
+            mRelatedObjects.append(object);
     }
 
+    // Sort the related objects by their stacking order
+    std::sort(mRelatedObjects.begin(), mRelatedObjects.end(),
+              [] (MapObject *a, MapObject *b) { return a->index() < b->index(); });
+
     for (MapObject *object : selectedObjects) {
         int index = mRelatedObjects.indexOf(object);
         Q_ASSERT(index != -1);
@@ -49,7 +49,6 @@ class RaiseLowerHelper
 public:
     RaiseLowerHelper(MapScene *mapScene)
         : mMapDocument(mapScene->mapDocument())
-        , mMapScene(mapScene)
         , mObjectGroup(nullptr)
     {}
 
@@ -65,7 +64,6 @@ private:
     void push(const QList<QUndoCommand *> &commands, const QString &text);
 
     MapDocument *mMapDocument;
-    MapScene *mMapScene;
 
     // Context
     ObjectGroup *mObjectGroup;
@@ -20,77 +20,108 @@
 
 #pragma once
 
-#include <QMap>
+#include <QtGlobal>
 
+#include <algorithm>
 #include <random>
+#include <vector>
 
 namespace Tiled {
 namespace Internal {
 
+/**
+ * Returns the random engine shared by the RandomPickers of the calling
+ * thread. It is seeded once from std::random_device, and can be seeded with
+ * a fixed value to make the following picks reproducible.
+ */
+inline std::default_random_engine &globalRandomEngine()
+{
+    static thread_local std::default_random_engine engine(std::random_device{}());
+    return engine;
+}
+
 /**
  * A class that helps pick random things that each have a probability
  * assigned.
+ *
+ * The cumulative probabilities are stored in a flat array, which is searched
+ * using binary search. The memory is kept when calling clear(), so that a
+ * single picker can be reused without allocations.
  */
 template<typename T, typename Real = qreal>
 class RandomPicker
 {
 public:
-    RandomPicker()
-        : mSum(0.0)
-        , mRandomEngine(std::random_device{}())
+    explicit RandomPicker(std::default_random_engine &randomEngine = globalRandomEngine())
+        : mRandomEngine(&randomEngine)
     {}
 
     void add(const T &value, Real probability = 1.0)
     {
         if (probability > 0) {
-            mSum += probability;
-            mThresholds.insert(mSum, value);
+            mValues.push_back(value);
+            mThresholds.push_back(sum() + probability);
         }
     }
 
     bool isEmpty() const
     {
-        return mThresholds.isEmpty();
+        return mValues.empty();
     }
 
-    const T &pick() const
+    int size() const
     {
-        Q_ASSERT(!isEmpty());
+        return static_cast<int>(mValues.size());
+    }
 
-        std::uniform_real_distribution<Real> dis(0, mSum);
-        const Real random = dis(mRandomEngine);
-        const auto it = mThresholds.lowerBound(random);
-        if (it != mThresholds.end())
-            return it.value();
-        else
-            return (mThresholds.end() - 1).value();
+    Real sum() const
+    {
+        return mThresholds.empty() ? Real(0) : mThresholds.back();
+    }
+
+    const T &pick() const
+    {
+        return mValues[pickIndex()];
     }
 
     //same as pick, but removes the selected element.
     T take()
     {
-        Q_ASSERT(!isEmpty());
+        const std::size_t index = pickIndex();
+        const Real probability = mThresholds[index] - (index > 0 ? mThresholds[index - 1] : Real(0));
 
-        std::uniform_real_distribution<Real> dis(0, mSum);
-        const Real random = dis(mRandomEngine);
-        const auto it = mThresholds.lowerBound(random);
+        for (std::size_t i = index + 1; i < mThresholds.size(); ++i)
+            mThresholds[i] -= probability;
 
-        if (it != mThresholds.end())
-            return mThresholds.take(it.key());
-        else
-            return mThresholds.take((it - 1).key());
+        T value = std::move(mValues[index]);
+        mValues.erase(mValues.begin() + index);
+        mThresholds.erase(mThresholds.begin() + index);
+        return value;
     }
 
     void clear()
     {
-        mSum = 0.0;
+        mValues.clear();
         mThresholds.clear();
     }
 
 private:
-    Real mSum;
-    QMap<Real, T> mThresholds;
-    mutable std::default_random_engine mRandomEngine;
+    std::size_t pickIndex() const
+    {
+        Q_ASSERT(!isEmpty());
+
+        std::uniform_real_distribution<Real> dis(0, sum());
+        const Real random = dis(*mRandomEngine);
+        const auto it = std::lower_bound(mThresholds.begin(), mThresholds.end(), random);
+        if (it != mThresholds.end())
+            return static_cast<std::size_t>(it - mThresholds.begin());
+        else
+            return mThresholds.size() - 1;
+    }
+
+    std::vector<T> mValues;
+    std::vector<Real> mThresholds;
+    std::default_random_engine *mRandomEngine;
 };
 
 } // namespace Internal
@@ -37,6 +37,7 @@
 #include "tilelayer.h"
 #include "tileset.h"
 
+#include <QVarLengthArray>
 #include <QVector>
 
 #include <climits>
@@ -251,32 +252,56 @@ static Tile *findBestTile(const Tileset &tileset, unsigned terrain, unsigned con
     // we should have hooked 0xFFFFFFFF terrains outside this function
     Q_ASSERT(terrain != 0xFFFFFFFF);
 
+    // Look up the penalty of each corner's target terrain only once. Index
+    // terrainCount is used for "no terrain" (0xFF).
+    const int terrainCount = tileset.terrainCount();
+    QVarLengthArray<int, 32> cornerPenalties[4];
+    for (int corner = 0; corner < 4; ++corner) {
+        const int target = (terrain >> (corner * 8)) & 0xFF;
+        QVarLengthArray<int, 32> &penalties = cornerPenalties[corner];
+        penalties.resize(terrainCount + 1);
+        for (int t = 0; t < terrainCount; ++t)
+            penalties[t] = tileset.terrainTransitionPenalty(t, target);
+        penalties[terrainCount] = tileset.terrainTransitionPenalty(0xFF, target);
+    }
+
+    auto cornerPenalty = [&] (unsigned tileTerrain, int corner) {
+        const int t = (tileTerrain >> (corner * 8)) & 0xFF;
+        if (t == 0xFF)
+            return cornerPenalties[corner][terrainCount];
+        return t < terrainCount ? cornerPenalties[corner][t] : -1;
+    };
+
     RandomPicker<Tile*> matches;
     int penalty = INT_MAX;
 
-    // TODO: this is a slow linear search, perhaps we could use a better find algorithm...
-    for (Tile *t : tileset.tiles()) {
-        if ((t->terrain() & considerationMask) != (terrain & considerationMask))
+    // Tiles with the same terrain information share their penalty, so only
+    // each distinct terrain combination needs to be considered
+    const auto &tilesByTerrain = tileset.tilesByTerrain();
+    for (auto it = tilesByTerrain.cbegin(); it != tilesByTerrain.cend(); ++it) {
+        const unsigned tileTerrain = it.key();
+        if ((tileTerrain & considerationMask) != (terrain & considerationMask))
             continue;
 
         // calculate the tile transition penalty based on shortest distance to target terrain type
-        int tr = tileset.terrainTransitionPenalty(t->terrain() >> 24, terrain >> 24);
-        int tl = tileset.terrainTransitionPenalty((t->terrain() >> 16) & 0xFF, (terrain >> 16) & 0xFF);
-        int br = tileset.terrainTransitionPenalty((t->terrain() >> 8) & 0xFF, (terrain >> 8) & 0xFF);
-        int bl = tileset.terrainTransitionPenalty(t->terrain() & 0xFF, terrain & 0xFF);
+        int bl = cornerPenalty(tileTerrain, 0);
+        int br = cornerPenalty(tileTerrain, 1);
+        int tl = cornerPenalty(tileTerrain, 2);
+        int tr = cornerPenalty(tileTerrain, 3);
 
         // if there is no path to the destination terrain, this isn't a useful transition
         if (tr < 0 || tl < 0 || br < 0 || bl < 0)
             continue;
 
-        // add tile to the candidate list
+        // add tiles to the candidate list
         int transitionPenalty = tr + tl + br + bl;
         if (transitionPenalty <= penalty) {
             if (transitionPenalty < penalty)
                 matches.clear();
             penalty = transitionPenalty;
 
-            matches.add(t, t->probability());
+            for (Tile *t : it.value())
+                matches.add(t, t->probability());
         }
     }
 
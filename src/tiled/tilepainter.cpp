@@ -23,8 +23,7 @@
 
 #include "mapdocument.h"
 #include "map.h"
-
-#include <QQueue>
+#include "regionbuilder.h"
 
 using namespace Tiled;
 using namespace Tiled::Internal;
@@ -84,8 +83,8 @@ Cell TilePainter::cellAt(int x, int y) const
 
 void TilePainter::setCell(int x, int y, const Cell &cell)
 {
-    const QRegion &selection = mMapDocument->selectedArea();
-    if (!(selection.isEmpty() || selection.contains(QPoint(x, y))))
+    const BitmapRegion &selection = mMapDocument->selectedCells();
+    if (!(selection.isEmpty() || selection.contains(x, y)))
         return;
 
     const int layerX = x - mTileLayer->x();
@@ -203,6 +202,44 @@ void TilePainter::erase(const QRegion &region)
     emit mMapDocument->regionChanged(paintable, mTileLayer);
 }
 
+namespace {
+
+/**
+ * Looks up cells in a tile layer, remembering the last chunk that was used
+ * since the flood fill mostly walks along rows.
+ */
+class CellReader
+{
+public:
+    explicit CellReader(const TileLayer *layer)
+        : mLayer(layer)
+    {}
+
+    const Cell &cellAt(int x, int y)
+    {
+        const QPoint chunkCoordinates(x < 0 ? (x + 1) / CHUNK_SIZE - 1 : x / CHUNK_SIZE,
+                                      y < 0 ? (y + 1) / CHUNK_SIZE - 1 : y / CHUNK_SIZE);
+        if (!mHasChunk || chunkCoordinates != mChunkCoordinates) {
+            mChunk = mLayer->findChunk(x, y);
+            mChunkCoordinates = chunkCoordinates;
+            mHasChunk = true;
+        }
+
+        if (mChunk)
+            return mChunk->cellAt(x & CHUNK_MASK, y & CHUNK_MASK);
+        return mEmptyCell;
+    }
+
+private:
+    const TileLayer *mLayer;
+    const Chunk *mChunk = nullptr;
+    QPoint mChunkCoordinates;
+    bool mHasChunk = false;
+    const Cell mEmptyCell;
+};
+
+} // anonymous namespace
+
 static QRegion fillRegion(const TileLayer *layer,
                           const QRegion &region,
                           QPoint fillOrigin,
@@ -214,8 +251,10 @@ static QRegion fillRegion(const TileLayer *layer,
     if (!region.contains(fillOrigin))
         return QRegion();
 
+    CellReader reader(layer);
+
     // Cache cell that we will match other cells against
-    const Cell matchCell = layer->cellAt(fillOrigin);
+    const Cell matchCell = reader.cellAt(fillOrigin.x(), fillOrigin.y());
 
     const QRect bounds = region.boundingRect();
     const int width = bounds.width();
@@ -224,38 +263,42 @@ static QRegion fillRegion(const TileLayer *layer,
 
     const bool isStaggered = orientation == Map::Hexagonal || orientation == Map::Staggered;
 
-    // Create a queue to hold cells that need filling
-    QQueue<QPoint> fillPositions;
-    fillPositions.enqueue(fillOrigin);
+    // Create a stack to hold cells that need filling (the order in which
+    // they are processed does not matter)
+    QVector<QPoint> fillPositions;
+    fillPositions.append(fillOrigin);
 
     // Create an array that will store which cells have been processed
     // This is faster than checking if a given cell is in the region/list
     QVector<bool> processedCellsVec(width * height);
     bool *processedCells = processedCellsVec.data();
-    QRegion fillRegion;
+    processedCells[indexOffset + fillOrigin.y() * width + fillOrigin.x()] = true;
+
+    // Collect the filled spans, the region is only created at the end
+    RegionBuilder fillRegion;
 
     // Loop through queued positions and fill them, while at the same time
     // checking adjacent positions to see if they should be added
     while (!fillPositions.isEmpty()) {
-        const QPoint currentPoint = fillPositions.dequeue();
+        const QPoint currentPoint = fillPositions.takeLast();
         const int startOfLine = currentPoint.y() * width;
 
         // Seek as far left as we can
         int left = currentPoint.x();
-        while (left > bounds.left() && layer->cellAt(left - 1, currentPoint.y()) == matchCell) {
+        while (left > bounds.left() && reader.cellAt(left - 1, currentPoint.y()) == matchCell) {
             --left;
             processedCells[indexOffset + startOfLine + left] = true;
         }
 
         // Seek as far right as we can
         int right = currentPoint.x();
-        while (right < bounds.right() && layer->cellAt(right + 1, currentPoint.y()) == matchCell) {
+        while (right < bounds.right() && reader.cellAt(right + 1, currentPoint.y()) == matchCell) {
             ++right;
             processedCells[indexOffset + startOfLine + right] = true;
         }
 
         // Add cells between left and right to the region
-        fillRegion += QRegion(left, currentPoint.y(), right - left + 1, 1);
+        fillRegion.addSpan(left, right, currentPoint.y());
 
         bool leftColumnIsStaggered = false;
         bool rightColumnIsStaggered = false;
@@ -276,16 +319,16 @@ static QRegion fillRegion(const TileLayer *layer,
 
         // Loop between left and right and check if cells above or below need
         // to be added to the queue.
-        auto findFillPositions = [=,&fillPositions](int left, int right, int y) {
+        auto findFillPositions = [=,&fillPositions,&reader](int left, int right, int y) {
             bool adjacentCellAdded = false;
 
             for (int x = left; x <= right; ++x) {
                 const int index = y * width + x;
 
-                if (!processedCells[indexOffset + index] && layer->cellAt(x, y) == matchCell) {
+                if (!processedCells[indexOffset + index] && reader.cellAt(x, y) == matchCell) {
                     // Do not add the cell to the queue if an adjacent cell was added.
                     if (!adjacentCellAdded) {
-                        fillPositions.enqueue(QPoint(x, y));
+                        fillPositions.append(QPoint(x, y));
                         adjacentCellAdded = true;
                     }
                 } else {
@@ -325,7 +368,7 @@ static QRegion fillRegion(const TileLayer *layer,
         }
     }
 
-    return fillRegion;
+    return fillRegion.region();
 }
 
 QRegion TilePainter::computePaintableFillRegion(const QPoint &fillOrigin) const
@@ -348,7 +391,7 @@ QRegion TilePainter::computePaintableFillRegion(const QPoint &fillOrigin) const
     region.translate(mTileLayer->position());
 
     if (!selection.isEmpty())
-        region &= selection;
+        region = mMapDocument->selectedCells().intersected(region);
 
     return region;
 }
@@ -367,8 +410,8 @@ QRegion TilePainter::computeFillRegion(const QPoint &fillOrigin) const
 //Ƿɻ
 bool TilePainter::isDrawable(int x, int y) const
 {
-    const QRegion &selection = mMapDocument->selectedArea();
-    if (!(selection.isEmpty() || selection.contains(QPoint(x, y))))
+    const BitmapRegion &selection = mMapDocument->selectedCells();
+    if (!(selection.isEmpty() || selection.contains(x, y)))
         return false;
 
     const int layerX = x - mTileLayer->x();
@@ -386,9 +429,9 @@ QRegion TilePainter::paintableRegion(const QRegion &region) const
     if (!mMapDocument->map()->infinite())
         intersection &= QRegion(mTileLayer->rect());
 
-    const QRegion &selection = mMapDocument->selectedArea();
+    const BitmapRegion &selection = mMapDocument->selectedCells();
     if (!selection.isEmpty())
-        intersection &= selection;
+        intersection = selection.intersected(intersection);
 
     return intersection;
 }
@@ -112,8 +112,8 @@ void TileSelectionTool::mouseReleased(QGraphicsSceneMouseEvent *event)
         mSelecting = false;
 
         MapDocument *document = mapDocument();
-        QRegion selection = document->selectedArea();
-        const QRect area = selectedArea();
+        BitmapRegion selection = document->selectedCells();
+        const BitmapRegion area(selectedArea());
 
         switch (selectionMode()) {
         case Replace:   selection = area; break;
@@ -122,7 +122,7 @@ void TileSelectionTool::mouseReleased(QGraphicsSceneMouseEvent *event)
         case Intersect: selection &= area; break;
         }
 
-        if (selection != document->selectedArea()) {
+        if (selection != document->selectedCells()) {
             QUndoCommand *cmd = new ChangeSelectedArea(document, selection);
             document->undoStack()->push(cmd);
         }
@@ -165,10 +165,13 @@ static void removeTileReferences(MapDocument *mapDocument,
         }
         case Layer::ObjectGroupType: {
             auto objectGroup = static_cast<ObjectGroup*>(layer);
+            QList<MapObject*> objects;
             for (MapObject *object : *objectGroup) {
                 if (condition(object->cell()))
-                    commands.append(new RemoveMapObject(mapDocument, object));
+                    objects.append(object);
             }
+            if (!objects.isEmpty())
+                commands.append(new RemoveMapObjects(mapDocument, objects));
             break;
         }
         case Layer::ImageLayerType:
@@ -354,7 +357,7 @@ void TilesetDock::selectTilesInStamp(const TileStamp &stamp)
 
     for (const TileStampVariation &variation : stamp.variations()) {
         for (auto layer : variation.map->tileLayers()) {
-            for (const Cell &cell : *static_cast<TileLayer*>(layer)) {
+            for (const Cell &cell : *static_cast<const TileLayer*>(layer)) {
                 if (Tile *tile = cell.tile()) {
                     if (processed.contains(tile))
                         continue;
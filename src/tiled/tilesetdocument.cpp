@@ -107,7 +107,7 @@ bool TilesetDocument::save(const QString &fileName, QString *error)
         return false;
     }
 
-    undoStack()->setClean();
+    setClean();
 
     mTileset->setFileName(fileName);
     setFileName(fileName);
@@ -141,7 +141,7 @@ bool TilesetDocument::reload(QString *error)
     tileset->setFormat(format);
 
     mUndoStack->push(new ReloadTileset(this, tileset));
-    mUndoStack->setClean();
+    setClean();
     mLastSaved = QFileInfo(fileName()).lastModified();
 
     return true;
@@ -220,14 +220,6 @@ void TilesetDocument::swapTileset(SharedTileset &tileset)
     emit tilesetChanged(mTileset.data());
 }
 
-/**
- * Used when a map that has this tileset embedded is saved.
- */
-void TilesetDocument::setClean()
-{
-    undoStack()->setClean();
-}
-
 void TilesetDocument::addMapDocument(MapDocument *mapDocument)
 {
     Q_ASSERT(!mMapDocuments.contains(mapDocument));
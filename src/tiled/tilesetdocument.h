@@ -80,7 +80,6 @@ public:
     const SharedTileset &tileset() const;
 
     bool isEmbedded() const;
-    void setClean();
 
     const QList<MapDocument*> &mapDocuments() const;
     void addMapDocument(MapDocument *mapDocument);
@@ -382,7 +382,7 @@ void TilesetEditor::setCurrentDocument(Document *document)
     }
 
     mPropertiesDock->setDocument(document);
-    mUndoDock->setStack(document ? document->undoStack() : nullptr);
+    mUndoDock->setDocument(document);
     mTileAnimationEditor->setTilesetDocument(tilesetDocument);
     mTileCollisionDock->setTilesetDocument(tilesetDocument);
     mTerrainDock->setDocument(document);
@@ -41,12 +41,16 @@
 #include <QHeaderView>
 #include <QMenu>
 #include <QPainter>
+#include <QPixmapCache>
 #include <QPinchGesture>
 #include <QScrollBar>
+#include <QStringBuilder>
 #include <QUndoCommand>
 #include <QWheelEvent>
 #include <QtCore/qmath.h>
 
+#include <functional>
+
 using namespace Tiled;
 using namespace Tiled::Internal;
 
@@ -175,15 +179,18 @@ static void paintCorners(QPainter *painter,
     }
 }
 //ûױ
-static void setCosmeticPen(QPainter *painter, const QBrush &brush, qreal width)
+static qreal devicePixelRatio(QPainter *painter)
 {
 #if QT_VERSION >= 0x050600
-    const qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+    return painter->device()->devicePixelRatioF();
 #else
-    const int devicePixelRatio = painter->device()->devicePixelRatio();
+    return painter->device()->devicePixelRatio();
 #endif
+}
 
-    QPen pen(brush, width * devicePixelRatio);
+static void setCosmeticPen(QPainter *painter, const QBrush &brush, qreal width)
+{
+    QPen pen(brush, width * devicePixelRatio(painter));
     pen.setCosmetic(true);
     painter->setPen(pen);
 }
@@ -525,6 +532,81 @@ static void paintWangOverlay(QPainter *painter,
     painter->restore();
 }
 
+/**
+ * Returns a transparent pixmap of the given \a size on which an overlay was
+ * drawn by \a paintOverlay. The pixmap is cached under the given \a key, so
+ * that the antialiased overlays only need to be drawn once for each
+ * combination of terrain or Wang ID and tile size.
+ */
+static QPixmap cachedOverlay(const QString &key,
+                             QSize size,
+                             qreal devicePixelRatio,
+                             const std::function<void(QPainter *, const QRect &)> &paintOverlay)
+{
+    const QString pixmapName = key % QLatin1Char('-')
+            % QString::number(size.width()) % QLatin1Char('x')
+            % QString::number(size.height()) % QLatin1Char('@')
+            % QString::number(devicePixelRatio);
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(pixmapName, pixmap)) {
+        pixmap = QPixmap(size * devicePixelRatio);
+        pixmap.setDevicePixelRatio(devicePixelRatio);
+        pixmap.fill(Qt::transparent);
+
+        QPainter painter(&pixmap);
+        paintOverlay(&painter, QRect(QPoint(), size));
+        painter.end();
+
+        QPixmapCache::insert(pixmapName, pixmap);
+    }
+    return pixmap;
+}
+
+static QPixmap terrainOverlay(unsigned terrain,
+                              int terrainTypeId,
+                              QSize size,
+                              qreal devicePixelRatio,
+                              const QColor &color)
+{
+    const QString key = QLatin1String("tiled_terrain-")
+            % QString::number(terrain) % QLatin1Char('-')
+            % QString::number(terrainTypeId) % QLatin1Char('-')
+            % QString::number(color.rgba());
+
+    return cachedOverlay(key, size, devicePixelRatio,
+                         [=] (QPainter *painter, const QRect &rect) {
+        paintTerrainOverlay(painter, terrain, terrainTypeId, rect, color);
+    });
+}
+
+static QPixmap wangOverlay(WangId wangId,
+                           WangSet *wangSet,
+                           QSize size,
+                           qreal devicePixelRatio)
+{
+    // The colors are part of the key, so changing them needs no invalidation
+    QString key = QLatin1String("tiled_wang-")
+            % QString::number(wangId) % QLatin1Char('-')
+            % QString::number(wangSet->edgeColorCount()) % QLatin1Char('-')
+            % QString::number(wangSet->cornerColorCount());
+
+    for (int i = 0; i < 4; ++i) {
+        const int edge = wangId.edgeColor(i);
+        if (edge > 0 && edge <= wangSet->edgeColorCount())
+            key += QLatin1Char('-') % QString::number(wangSet->edgeColorAt(edge)->color().rgba());
+
+        const int corner = wangId.cornerColor(i);
+        if (corner > 0 && corner <= wangSet->cornerColorCount())
+            key += QLatin1Char('-') % QString::number(wangSet->cornerColorAt(corner)->color().rgba());
+    }
+
+    return cachedOverlay(key, size, devicePixelRatio,
+                         [=] (QPainter *painter, const QRect &rect) {
+        paintWangOverlay(painter, wangId, wangSet, rect);
+    });
+}
+
 void TileDelegate::paint(QPainter *painter,
                          const QStyleOptionViewItem &option,
                          const QModelIndex &index) const
@@ -538,8 +620,8 @@ void TileDelegate::paint(QPainter *painter,
     const int extra = mTilesetView->drawGrid() ? 1 : 0;
     const qreal zoom = mTilesetView->scale();
 
-    QSize tileSize = tileImage.size();
-    if (tileImage.isNull()) {
+    QSize tileSize = tile->size();
+    if (tileSize.isEmpty()) {
         Tileset *tileset = model->tileset();
         if (tileset->isCollection()) {
             tileSize = QSize(32, 32);
@@ -561,8 +643,10 @@ void TileDelegate::paint(QPainter *painter,
         if (zoomable->smoothTransform())
             painter->setRenderHint(QPainter::SmoothPixmapTransform);
 
+    const qreal pixelRatio = devicePixelRatio(painter);
+
     if (!tileImage.isNull())
-        painter->drawPixmap(targetRect, tileImage);
+        painter->drawPixmap(targetRect, mTilesetView->tileThumbnail(tileImage, targetRect.size(), pixelRatio));
     else
         mTilesetView->imageMissingIcon().paint(painter, targetRect, Qt::AlignBottom | Qt::AlignLeft);
 
@@ -617,9 +701,10 @@ void TileDelegate::paint(QPainter *painter,
 
         const unsigned terrain = tile->terrain();
 
-        paintTerrainOverlay(painter, terrain,
-                            mTilesetView->terrainId(), targetRect,
-                            highlight.color());
+        painter->drawPixmap(targetRect.topLeft(),
+                            terrainOverlay(terrain, mTilesetView->terrainId(),
+                                           targetRect.size(), pixelRatio,
+                                           highlight.color()));
 
         // Overlay with terrain corner indication when hovered
         if (index == mTilesetView->hoveredIndex()) {
@@ -651,16 +736,16 @@ void TileDelegate::paint(QPainter *painter,
 
         if (WangSet *wangSet = mTilesetView->wangSet()) {
 
-            paintWangOverlay(painter, wangSet->wangIdOfTile(tile),
-                             wangSet,
-                             targetRect);
+            painter->drawPixmap(targetRect.topLeft(),
+                                wangOverlay(wangSet->wangIdOfTile(tile), wangSet,
+                                            targetRect.size(), pixelRatio));
 
             if (mTilesetView->hoveredIndex() == index) {
                 qreal opacity = painter->opacity();
                 painter->setOpacity(0.9);
-                paintWangOverlay(painter, mTilesetView->wangId(),
-                                 wangSet,
-                                 targetRect);
+                painter->drawPixmap(targetRect.topLeft(),
+                                    wangOverlay(mTilesetView->wangId(), wangSet,
+                                                targetRect.size(), pixelRatio));
                 painter->setOpacity(opacity);
             }
         }
@@ -676,10 +761,10 @@ QSize TileDelegate::sizeHint(const QStyleOptionViewItem & /* option */,
     const int extra = mTilesetView->drawGrid() ? 1 : 0;
 
     if (const Tile *tile = m->tileAt(index)) {
-        const QPixmap &image = tile->image();
-        QSize tileSize = image.size();
+        // Avoid loading pending images just to lay out the view
+        QSize tileSize = tile->size();
 
-        if (image.isNull()) {
+        if (tileSize.isEmpty()) {
             Tileset *tileset = m->tileset();
             if (tileset->isCollection()) {
                 tileSize = QSize(32, 32);
@@ -741,6 +826,8 @@ TilesetView::TilesetView(QWidget *parent)
     Preferences *prefs = Preferences::instance();
     mDrawGrid = prefs->showTilesetGrid();
 
+    mThumbnails.setMaxCost(64 * 1024);
+
     grabGesture(Qt::PinchGesture);
 
     connect(prefs, &Preferences::showTilesetGridChanged,
@@ -793,6 +880,42 @@ qreal TilesetView::scale() const
     return mZoomable->scale();
 }
 
+/**
+ * Returns the tile \a image scaled to \a size, for painting on a device with
+ * the given \a devicePixelRatio.
+ *
+ * Scaling the tile images on each paint makes scrolling through large
+ * tilesets slow, so the scaled images are cached. Each zoom level gets its
+ * own thumbnails, and those of zoom levels no longer used are evicted as new
+ * ones are added.
+ */
+QPixmap TilesetView::tileThumbnail(const QPixmap &image, QSize size,
+                                   qreal devicePixelRatio) const
+{
+    const QSize pixelSize = size * devicePixelRatio;
+    if (image.size() == pixelSize || pixelSize.isEmpty())
+        return image;
+
+    const bool smooth = mZoomable->smoothTransform();
+    const QString key = QString::number(image.cacheKey()) % QLatin1Char('-')
+            % QString::number(pixelSize.width()) % QLatin1Char('x')
+            % QString::number(pixelSize.height())
+            % (smooth ? QLatin1String("-smooth") : QLatin1String(""));
+
+    if (const QPixmap *thumbnail = mThumbnails.object(key))
+        return *thumbnail;
+
+    QPixmap thumbnail = image.scaled(pixelSize, Qt::IgnoreAspectRatio,
+                                     smooth ? Qt::SmoothTransformation
+                                            : Qt::FastTransformation);
+    thumbnail.setDevicePixelRatio(devicePixelRatio);
+
+    const int cost = thumbnail.width() * thumbnail.height() * thumbnail.depth() / 8 / 1024;
+    mThumbnails.insert(key, new QPixmap(thumbnail), qMax(1, cost));
+
+    return thumbnail;
+}
+
 void TilesetView::setModel(QAbstractItemModel *model)
 {
     QTableView::setModel(model);
@@ -1311,6 +1434,15 @@ void TilesetView::swapTiles()
     emit swapTilesRequested(tile1, tile2);
 }
 
+void TilesetView::scrollContentsBy(int dx, int dy)
+{
+    QTableView::scrollContentsBy(dx, dy);
+
+    // Scrolling down moves the contents up, revealing the rows below
+    if (dy != 0)
+        preloadTileImages(dy < 0 ? 1 : -1);
+}
+
 void TilesetView::setDrawGrid(bool drawGrid)
 {
     mDrawGrid = drawGrid;
@@ -1405,6 +1537,44 @@ Tile *TilesetView::currentTile() const
     return model ? model->tileAt(currentIndex()) : nullptr;
 }
 
+/**
+ * Starts decoding the pending images of the tiles one page beyond the
+ * visible rows, in the given scrolling \a direction, so that they are
+ * usually ready by the time they scroll into view.
+ */
+void TilesetView::preloadTileImages(int direction)
+{
+    const TilesetModel *model = tilesetModel();
+    if (!model || !model->tileset()->isCollection())
+        return;
+
+    const int rowCount = model->rowCount();
+    if (rowCount == 0)
+        return;
+
+    int firstRow = rowAt(0);
+    int lastRow = rowAt(viewport()->height() - 1);
+    if (firstRow == -1)
+        firstRow = 0;
+    if (lastRow == -1)
+        lastRow = rowCount - 1;
+
+    const int pageRows = lastRow - firstRow + 1;
+    if (direction > 0) {
+        firstRow = lastRow + 1;
+        lastRow = qMin(lastRow + pageRows, rowCount - 1);
+    } else {
+        lastRow = firstRow - 1;
+        firstRow = qMax(firstRow - pageRows, 0);
+    }
+
+    const int columnCount = model->columnCount();
+    for (int row = firstRow; row <= lastRow; ++row)
+        for (int column = 0; column < columnCount; ++column)
+            if (const Tile *tile = model->tileAt(model->index(row, column)))
+                tile->preloadImage();
+}
+
 void TilesetView::setHandScrolling(bool handScrolling)
 {
     if (mHandScrolling == handScrolling)
@@ -23,6 +23,7 @@
 #include "tilesetmodel.h"
 #include "wangset.h"
 
+#include <QCache>
 #include <QTableView>
 
 namespace Tiled {
@@ -125,6 +126,9 @@ public:
 
     QIcon imageMissingIcon() const;
 
+    QPixmap tileThumbnail(const QPixmap &image, QSize size,
+                          qreal devicePixelRatio) const;
+
     void updateBackgroundColor();
 
 signals:
@@ -146,6 +150,7 @@ protected:
     void leaveEvent(QEvent *) override;
     void wheelEvent(QWheelEvent *event) override;
     void contextMenuEvent(QContextMenuEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
 
 private slots:
     void addTerrainType();
@@ -165,6 +170,7 @@ private:
     void finishWangIdChange();
     Tile *currentTile() const;
     void setHandScrolling(bool handScrolling);
+    void preloadTileImages(int direction);
 
     enum WangBehavior {
         WholeId, //Assigning templates
@@ -194,6 +200,9 @@ private:
     QPoint mLastMousePos;
 
     const QIcon mImageMissingIcon;
+
+    // Scaled tile images, with their size in KiB as cost
+    mutable QCache<QString, QPixmap> mThumbnails;
 };
 
 inline TilesetDocument *TilesetView::tilesetDocument() const
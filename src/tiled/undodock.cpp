@@ -21,7 +21,14 @@
 
 #include "undodock.h"
 
+#include "document.h"
+#include "preferences.h"
+
 #include <QEvent>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QSpinBox>
+#include <QUndoStack>
 #include <QUndoView>
 #include <QVBoxLayout>
 
@@ -38,18 +45,54 @@ UndoDock::UndoDock(QWidget *parent)
     mUndoView->setCleanIcon(cleanIcon);
     mUndoView->setUniformItemSizes(false);
 
+    Preferences *prefs = Preferences::instance();
+
+    mMemoryUsageLabel = new QLabel(this);
+    mMemoryLimitLabel = new QLabel(this);
+
+    mMemoryLimit = new QSpinBox(this);
+    mMemoryLimit->setRange(0, 65536);
+    mMemoryLimit->setSingleStep(64);
+    mMemoryLimit->setValue(prefs->undoMemoryLimit());
+    mMemoryLimitLabel->setBuddy(mMemoryLimit);
+
+    QHBoxLayout *memoryLayout = new QHBoxLayout;
+    memoryLayout->setContentsMargins(4, 2, 4, 2);
+    memoryLayout->addWidget(mMemoryUsageLabel);
+    memoryLayout->addStretch();
+    memoryLayout->addWidget(mMemoryLimitLabel);
+    memoryLayout->addWidget(mMemoryLimit);
+
     QWidget *widget = new QWidget(this);
     QVBoxLayout *layout = new QVBoxLayout(widget);
     layout->setMargin(0);
+    layout->setSpacing(0);
     layout->addWidget(mUndoView);
+    layout->addLayout(memoryLayout);
 
     setWidget(widget);
     retranslateUi();
+
+    connect(mMemoryLimit, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            prefs, &Preferences::setUndoMemoryLimit);
+    connect(prefs, &Preferences::undoMemoryLimitChanged,
+            mMemoryLimit, &QSpinBox::setValue);
 }
 
-void UndoDock::setStack(QUndoStack *stack)
+void UndoDock::setDocument(Document *document)
 {
-    mUndoView->setStack(stack);
+    if (mDocument)
+        mDocument->disconnect(this);
+
+    mDocument = document;
+    mUndoView->setStack(document ? document->undoStack() : nullptr);
+
+    if (document) {
+        connect(document, &Document::undoMemoryUsageChanged,
+                this, &UndoDock::updateMemoryUsage);
+    }
+
+    updateMemoryUsage();
 }
 
 void UndoDock::changeEvent(QEvent *e)
@@ -68,4 +111,21 @@ void UndoDock::retranslateUi()
 {
     setWindowTitle(tr("History"));
     mUndoView->setEmptyLabel(tr("<empty>"));
+    mMemoryLimitLabel->setText(tr("&Limit:"));
+    mMemoryLimit->setSuffix(tr(" MiB"));
+    mMemoryLimit->setSpecialValueText(tr("None"));
+    mMemoryLimit->setToolTip(tr("When exceeded, the history is cleared and earlier "
+                                "changes can no longer be undone"));
+    updateMemoryUsage();
+}
+
+/**
+ * Shows an estimate of the memory used by the tile changes stored in the
+ * undo stack.
+ */
+void UndoDock::updateMemoryUsage()
+{
+    const qint64 usage = mDocument ? mDocument->undoMemoryUsage() : 0;
+    const double mebibytes = usage / (1024.0 * 1024.0);
+    mMemoryUsageLabel->setText(tr("Tile changes: %1 MiB").arg(mebibytes, 0, 'f', 1));
 }
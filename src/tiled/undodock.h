@@ -22,13 +22,17 @@
 #pragma once
 
 #include <QDockWidget>
+#include <QPointer>
 
-class QUndoStack;
+class QLabel;
+class QSpinBox;
 class QUndoView;
 
 namespace Tiled {
 namespace Internal {
 
+class Document;
+
 /**
  * A dock widget showing the undo stack. Mainly for debugging, but can also be
  * useful for the user.
@@ -40,14 +44,20 @@ class UndoDock : public QDockWidget
 public:
     UndoDock(QWidget *parent = nullptr);
 
-    void setStack(QUndoStack *stack);
+    void setDocument(Document *document);
 
 protected:
     void changeEvent(QEvent *e) override;
 
 private:
     void retranslateUi();
+    void updateMemoryUsage();
+
     QUndoView *mUndoView;
+    QLabel *mMemoryUsageLabel;
+    QLabel *mMemoryLimitLabel;
+    QSpinBox *mMemoryLimit;
+    QPointer<Document> mDocument;
 };
 
 } // namespace Internal
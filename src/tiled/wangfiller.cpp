@@ -80,6 +80,79 @@ static void getSurroundingPoints(QPoint point,
             points[i] = point + aroundTilePoints[i];
     }
 }
+
+namespace {
+
+/**
+ * The WangIds of the cells of a back layer around a fill region, along with
+ * a bitmap of the fill region, stored in flat arrays covering the bounding
+ * rect of the region plus a margin. This avoids repeated cell, WangId and
+ * region lookups while filling.
+ */
+class WangFillGrid
+{
+public:
+    WangFillGrid(const WangSet &wangSet,
+                 const TileLayer &back,
+                 const QRegion &fillRegion)
+    {
+        // Surrounding points on staggered maps may be up to two cells away
+        mRect = fillRegion.boundingRect().adjusted(-2, -2, 2, 2);
+
+        const int size = mRect.width() * mRect.height();
+        mInRegion.fill(false, size);
+        mBackWangIds.fill(0, size);
+
+#if QT_VERSION < 0x050800
+        const auto rects = fillRegion.rects();
+        for (const QRect &rect : rects) {
+#else
+        for (const QRect &rect : fillRegion) {
+#endif
+            for (int y = rect.top(); y <= rect.bottom(); ++y)
+                for (int x = rect.left(); x <= rect.right(); ++x)
+                    mInRegion[index(QPoint(x, y))] = true;
+        }
+
+        for (int y = mRect.top(); y <= mRect.bottom(); ++y) {
+            for (int x = mRect.left(); x <= mRect.right(); ++x) {
+                const int i = index(QPoint(x, y));
+                if (!mInRegion.at(i))
+                    mBackWangIds[i] = wangSet.wangIdOfCell(back.cellAt(x, y));
+            }
+        }
+    }
+
+    int size() const { return mInRegion.size(); }
+
+    int index(QPoint point) const
+    {
+        return (point.y() - mRect.y()) * mRect.width() + (point.x() - mRect.x());
+    }
+
+    bool contains(QPoint point) const { return mRect.contains(point); }
+
+    bool inRegion(QPoint point) const
+    {
+        return contains(point) && mInRegion.at(index(point));
+    }
+
+    /**
+     * Returns the WangId of the back layer at the given \a point, or 0 when
+     * the point is part of the fill region.
+     */
+    WangId backWangId(QPoint point) const
+    {
+        return contains(point) ? mBackWangIds.at(index(point)) : WangId();
+    }
+
+private:
+    QRect mRect;
+    QVector<bool> mInRegion;
+    QVector<WangId> mBackWangIds;
+};
+
+} // anonymous namespace
 //ҵʱCEll
 Cell WangFiller::findFittingCell(const TileLayer &back,
                                  const TileLayer &front,
@@ -153,34 +226,32 @@ std::unique_ptr<TileLayer> WangFiller::fillRegion(const TileLayer &back,
                                                          boundingRect.width(),
                                                          boundingRect.height()) };
 
-    QVector<WangId> wangIds(tileLayer->width() * tileLayer->height(), 0);
+    // Look up the back layer only once, and keep track of the WangIds the
+    // filled cells need to match in a flat array
+    const WangFillGrid grid(*mWangSet, back, fillRegion);
+    QVector<WangId> wangIds(grid.size(), 0);
+    QVector<bool> filled(grid.size(), false);
+
+    QPoint adjacentPoints[8];
+    WangId surroundingWangIds[8];
+    RandomPicker<WangTile> wangTiles;
+
 #if QT_VERSION < 0x050800
     const auto rects = fillRegion.rects();
     for (const QRect &rect : rects) {
 #else
     for (const QRect &rect : fillRegion) {
 #endif
-        for (int x = rect.left(); x <= rect.right(); ++x) {
-            int index = x - tileLayer->x() + (rect.top() - tileLayer->y()) * tileLayer->width();
-            wangIds[index] = wangIdFromSurroundings(back,
-                                                    fillRegion,
-                                                    QPoint(x, rect.top()));
-
-            index = x - tileLayer->x() + (rect.bottom() - tileLayer->y()) * tileLayer->width();
-            wangIds[index] = wangIdFromSurroundings(back,
-                                                    fillRegion,
-                                                    QPoint(x, rect.bottom()));
-        }
-        for (int y = rect.top() + 1; y < rect.bottom(); ++y) {
-            int index = rect.left() - tileLayer->x() + (y - tileLayer->y()) * tileLayer->width();
-            wangIds[index] = wangIdFromSurroundings(back,
-                                                    fillRegion,
-                                                    QPoint(rect.left(), y));
-
-            index = rect.right() - tileLayer->x() + (y - tileLayer->y()) * tileLayer->width();
-            wangIds[index] = wangIdFromSurroundings(back,
-                                                    fillRegion,
-                                                    QPoint(rect.right(), y));
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            for (int x = rect.left(); x <= rect.right(); ++x) {
+                const QPoint point(x, y);
+                getSurroundingPoints(point, mStaggeredRenderer, mStaggerAxis, adjacentPoints);
+
+                for (int i = 0; i < 8; ++i)
+                    surroundingWangIds[i] = grid.backWangId(adjacentPoints[i]);
+
+                wangIds[grid.index(point)] = mWangSet->wangIdFromSurrounding(surroundingWangIds);
+            }
         }
     }
 
@@ -192,10 +263,12 @@ std::unique_ptr<TileLayer> WangFiller::fillRegion(const TileLayer &back,
         for (int y = rect.top(); y <= rect.bottom(); ++y) {
             for (int x = rect.left(); x <= rect.right(); ++x) {
                 QPoint currentPoint(x, y);
-                int currentIndex = (currentPoint.y() - tileLayer->y()) * tileLayer->width() + (currentPoint.x() - tileLayer->x());
+                const int currentIndex = grid.index(currentPoint);
+
+                getSurroundingPoints(currentPoint, mStaggeredRenderer, mStaggerAxis, adjacentPoints);
 
                 QList<WangTile> wangTilesList = mWangSet->findMatchingWangTiles(wangIds[currentIndex]);
-                RandomPicker<WangTile> wangTiles;
+                wangTiles.clear();
 
                 for (const WangTile &wangTile : wangTilesList)
                     wangTiles.add(wangTile, mWangSet->wangTileProbability(wangTile));
@@ -205,17 +278,12 @@ std::unique_ptr<TileLayer> WangFiller::fillRegion(const TileLayer &back,
 
                     bool fill = true;
                     if (!mWangSet->isComplete()) {
-                        QPoint adjacentPoints[8];
-                        getSurroundingPoints(currentPoint, mStaggeredRenderer, mStaggerAxis, adjacentPoints);
-
                         for (int i = 0; i < 8; ++i) {
-                            QPoint p = adjacentPoints[i];
-                            if (!fillRegion.contains(p) || !tileLayer->cellAt(p - tileLayer->position()).isEmpty())
+                            const QPoint p = adjacentPoints[i];
+                            if (!grid.inRegion(p) || filled.at(grid.index(p)))
                                 continue;
-                            p -= tileLayer->position();
-                            int index = p.y() * tileLayer->width() + p.x();
 
-                            WangId adjacentWangId = wangIds[index];
+                            WangId adjacentWangId = wangIds[grid.index(p)];
                             adjacentWangId.updateToAdjacent(wangTile.wangId(), (i + 4) % 8);
 
                             if (!mWangSet->wildWangIdIsUsed(adjacentWangId)) {
@@ -230,15 +298,13 @@ std::unique_ptr<TileLayer> WangFiller::fillRegion(const TileLayer &back,
                         tileLayer->setCell(currentPoint.x() - tileLayer->x(),
                                            currentPoint.y() - tileLayer->y(),
                                            wangTile.makeCell());
-                        QPoint adjacentPoints[8];
-                        getSurroundingPoints(currentPoint, mStaggeredRenderer, mStaggerAxis, adjacentPoints);
+                        filled[currentIndex] = true;
+
                         for (int i = 0; i < 8; ++i) {
-                            QPoint p = adjacentPoints[i];
-                            if (!fillRegion.contains(p) || !tileLayer->cellAt(p - tileLayer->position()).isEmpty())
+                            const QPoint p = adjacentPoints[i];
+                            if (!grid.inRegion(p) || filled.at(grid.index(p)))
                                 continue;
-                            p -= tileLayer->position();
-                            int index = p.y() * tileLayer->width() + p.x();
-                            wangIds[index].updateToAdjacent(wangTile.wangId(), (i + 4) % 8);
+                            wangIds[grid.index(p)].updateToAdjacent(wangTile.wangId(), (i + 4) % 8);
                         }
                         break;
                     }
@@ -276,20 +342,3 @@ WangId WangFiller::wangIdFromSurroundings(const TileLayer &back,
 
     return mWangSet->wangIdFromSurrounding(surroundingCells);
 }
-
-WangId WangFiller::wangIdFromSurroundings(const TileLayer &back,
-                                          const QRegion &fillRegion,
-                                          QPoint point) const
-{
-    Cell surroundingCells[8];
-
-    QPoint adjacentPoints[8];
-    getSurroundingPoints(point, mStaggeredRenderer, mStaggerAxis, adjacentPoints);
-
-    for (int i = 0; i < 8; ++i) {
-        if (!fillRegion.contains(adjacentPoints[i]))
-            surroundingCells[i] = back.cellAt(adjacentPoints[i]);
-    }
-
-    return mWangSet->wangIdFromSurrounding(surroundingCells);
-}
@@ -95,14 +95,6 @@ private:
                                   const QRegion &fillRegion,
                                   QPoint point) const;
 
-    /**
-     * Returns a wangId based on cells from \a back which are not in the
-     * \a fillRegion. \a point and \a fillRegion are relative to \a back.
-     */
-    WangId wangIdFromSurroundings(const TileLayer &back,
-                                  const QRegion &fillRegion,
-                                  QPoint point) const;
-
     WangSet *mWangSet;
     StaggeredRenderer *mStaggeredRenderer;
     Map::StaggerAxis mStaggerAxis;